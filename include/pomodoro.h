@@ -3,6 +3,10 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#include <zephyr/devicetree.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/toolchain.h>
+
 enum pomodoro_state {
     POMODORO_STATE_IDLE = 0,
     POMODORO_STATE_WORK,
@@ -10,9 +14,30 @@ enum pomodoro_state {
     POMODORO_STATE_PAUSED,
 };
 
+/*
+ * The schedule is fixed at build time by the node chosen as zmk,pomodoro-plan
+ * (see dts/bindings/zmk,pomodoro-plan.yaml), or the classic 25/5 x4 plan.
+ */
+#if DT_HAS_CHOSEN(zmk_pomodoro_plan)
+#define POMODORO_PLAN_NODE DT_CHOSEN(zmk_pomodoro_plan)
+#define POMODORO_DEFAULT_WORK_SECONDS (DT_PROP(POMODORO_PLAN_NODE, work_minutes) * 60)
+#define POMODORO_DEFAULT_BREAK_SECONDS (DT_PROP(POMODORO_PLAN_NODE, break_minutes) * 60)
+#define POMODORO_LONG_BREAK_SECONDS                                                                \
+    (DT_PROP_OR(POMODORO_PLAN_NODE, long_break_minutes,                                            \
+                DT_PROP(POMODORO_PLAN_NODE, break_minutes)) * 60)
+#define POMODORO_MAX_SESSIONS DT_PROP(POMODORO_PLAN_NODE, sessions)
+#else
 #define POMODORO_DEFAULT_WORK_SECONDS (25 * 60)
 #define POMODORO_DEFAULT_BREAK_SECONDS (5 * 60)
+#define POMODORO_LONG_BREAK_SECONDS POMODORO_DEFAULT_BREAK_SECONDS
 #define POMODORO_MAX_SESSIONS 4
+#endif
+
+BUILD_ASSERT(POMODORO_MAX_SESSIONS >= 1 && POMODORO_MAX_SESSIONS <= UINT8_MAX,
+             "pomodoro plan needs 1-255 sessions");
+BUILD_ASSERT(POMODORO_DEFAULT_WORK_SECONDS > 0 && POMODORO_DEFAULT_BREAK_SECONDS > 0 &&
+                 POMODORO_LONG_BREAK_SECONDS > 0,
+             "pomodoro plan phases must be at least a minute");
 
 enum pomodoro_action {
     POMODORO_ACTION_START = 0,
@@ -33,8 +58,17 @@ struct pomodoro_status {
     uint32_t remaining_seconds;
     uint32_t phase_total_seconds;
     bool resume_on_any_key;
+    /* False while the adaptive countdown renders whole minutes only. */
+    bool show_seconds;
+    /* Bumped on every committed state change; the countdown alone never bumps it. */
+    uint32_t generation;
+    /* pomodoro_clock_now_ms() time the running phase ends at, 0 while idle or paused. */
+    int64_t phase_end_ms;
 };
 
+/* Applies `action` through the (state, action) transition table. */
+int pomodoro_dispatch(enum pomodoro_action action);
+
 int pomodoro_start(void);
 int pomodoro_pause(void);
 int pomodoro_stop(void);
@@ -43,4 +77,15 @@ int pomodoro_resume(void);
 int pomodoro_break_extend(void);
 int pomodoro_break_skip(void);
 
+/*
+ * Lock-free: safe to call at any rate and from any context, it never contends
+ * with the timer path. remaining_seconds is extrapolated at call time.
+ */
 struct pomodoro_status pomodoro_current_status(void);
+uint32_t pomodoro_status_generation(void);
+bool pomodoro_status_changed_since(uint32_t generation);
+
+#if IS_ENABLED(CONFIG_ZTEST)
+/* Drops the in-RAM state without saving it and restores from settings, as a reset would. */
+void pomodoro_test_reboot(void);
+#endif
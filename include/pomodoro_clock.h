@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <zephyr/sys/util.h>
+
+/*
+ * Timebase for phase accounting plus the one wakeup pomodoro_timer keeps
+ * armed for the earliest of its timers.
+ * Backed by kernel uptime, by a free-running hardware counter when
+ * CONFIG_ZMK_POMODORO_COUNTER_WAKE is set, or by a hand-driven virtual clock
+ * with CONFIG_ZMK_POMODORO_CLOCK_VIRTUAL.
+ */
+
+typedef void (*pomodoro_clock_expiry_t)(void);
+
+/* The expiry callback always runs on pomodoro_work_q(), never from an ISR. */
+int pomodoro_clock_init(pomodoro_clock_expiry_t expiry);
+int64_t pomodoro_clock_now_ms(void);
+void pomodoro_clock_arm(int64_t deadline_ms);
+void pomodoro_clock_cancel(void);
+
+/* Runs the expiry callback as soon as the queue gets to it, e.g. to catch up after sleep. */
+void pomodoro_clock_kick(void);
+
+#if IS_ENABLED(CONFIG_ZMK_POMODORO_CLOCK_VIRTUAL)
+/* Moves virtual time forward, running the expiry callback at each armed deadline passed. */
+void pomodoro_clock_advance(uint32_t ms);
+
+/*
+ * Moves virtual time forward without firing anything, like a wakeup lost to
+ * sleep. The next advance or kick delivers the overdue expiry late.
+ */
+void pomodoro_clock_jump(uint32_t ms);
+#endif
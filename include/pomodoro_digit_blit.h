@@ -0,0 +1,52 @@
+#pragma once
+
+#include <errno.h>
+#include <stdint.h>
+
+#include <zephyr/sys/util.h>
+
+#include <lvgl.h>
+
+/* Seven-segment cell geometry of the built-in atlas, before scaling. */
+#define POMODORO_DIGIT_GLYPH_WIDTH 8
+#define POMODORO_DIGIT_GLYPH_HEIGHT 14
+#define POMODORO_DIGIT_SCALE 2
+#define POMODORO_DIGIT_BLIT_HEIGHT (POMODORO_DIGIT_GLYPH_HEIGHT * POMODORO_DIGIT_SCALE)
+
+#if IS_ENABLED(CONFIG_ZMK_POMODORO_DISPLAY_DIGIT_BLIT)
+/*
+ * Takes over the POMODORO_DIGIT_BLIT_HEIGHT panel rows starting at `rows->y1`
+ * and renders the countdown into them straight through display_write(). The
+ * owner must leave those rows to the blitter; whenever LVGL repaints any of
+ * them while drawing `owner`, the digits are written again. Returns a negative
+ * errno when the display cannot be driven this way, in which case the caller
+ * keeps drawing the countdown itself.
+ */
+int pomodoro_digit_blit_attach(lv_obj_t *owner, const lv_area_t *rows);
+
+/*
+ * Renders "MM:SS" and takes the rows back if they were released; returns the
+ * number of pixel rows written (0 if unchanged).
+ */
+uint16_t pomodoro_digit_blit_show(const char *text);
+
+/*
+ * Hands the rows back to the owner, for text the atlas has no glyphs for.
+ * Until the next pomodoro_digit_blit_show() LVGL repaints of them are left
+ * alone.
+ */
+void pomodoro_digit_blit_release(void);
+#else
+static inline int pomodoro_digit_blit_attach(lv_obj_t *owner, const lv_area_t *rows) {
+    ARG_UNUSED(owner);
+    ARG_UNUSED(rows);
+    return -ENOTSUP;
+}
+
+static inline uint16_t pomodoro_digit_blit_show(const char *text) {
+    ARG_UNUSED(text);
+    return 0;
+}
+
+static inline void pomodoro_digit_blit_release(void) {}
+#endif
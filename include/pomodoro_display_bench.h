@@ -0,0 +1,44 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "pomodoro.h"
+
+/* One replayed frame. `crc` covers only what this frame flushed, area headers included. */
+struct pomodoro_display_bench_frame {
+    uint32_t apply_cyc;
+    uint32_t render_cyc;
+    uint32_t invalidated_px;
+    uint32_t flushed_px;
+    uint16_t flushed_rows;
+    uint32_t crc;
+};
+
+/*
+ * Replays the built-in first session through the display on the display work
+ * queue and waits for it. Returns the number of frames, with `replay`
+ * pointing at them until the next run, or a negative errno when there is no
+ * UI to drive.
+ */
+int pomodoro_display_bench_run(const struct pomodoro_display_bench_frame **replay);
+
+/* CRC-32 over the per-frame CRCs: one number for the whole replay. */
+uint32_t pomodoro_display_bench_crc(const struct pomodoro_display_bench_frame *replay,
+                                    size_t count);
+
+/*
+ * Hooks for the replay. Both must be called from the display work queue,
+ * which owns LVGL and the display's frame state.
+ */
+
+/*
+ * Applies `status` as the next frame, bypassing the draw request path. With
+ * `from_scratch` the view forgets what it shows and invalidates everything,
+ * as right after the UI is built. False when there is no UI.
+ */
+bool pomodoro_display_bench_apply(const struct pomodoro_status *status, bool from_scratch);
+
+/* Hands the display back to the live engine state. */
+void pomodoro_display_bench_end(void);
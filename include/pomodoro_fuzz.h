@@ -0,0 +1,25 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "pomodoro.h"
+
+/* How far a pomodoro_fuzz_run() got, and what it tripped over if it failed. */
+struct pomodoro_fuzz_result {
+    /* Steps run, including the failing one. */
+    uint32_t steps;
+    uint32_t transitions;
+    /* NULL unless a check failed, on step `steps - 1`. */
+    const char *failure;
+    /* The engine's status at the failure. */
+    struct pomodoro_status status;
+};
+
+/*
+ * Drives `steps` random actions and virtual clock jumps from `seed` (0 counts
+ * as 1) through the engine, checking every status against a model of the
+ * actions and timed transitions kept apart from the engine. Returns 0, or
+ * -EIO at the first failed check. Stops the engine first and leaves it
+ * wherever the last step put it.
+ */
+int pomodoro_fuzz_run(uint32_t steps, uint32_t seed, struct pomodoro_fuzz_result *result);
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <zephyr/sys/util.h>
+#include <zephyr/toolchain.h>
+
+#define POMODORO_HISTORY_FLAG_BREAK BIT(0)
+#define POMODORO_HISTORY_FLAG_LONG_BREAK BIT(1)
+#define POMODORO_HISTORY_FLAG_SKIPPED BIT(2)
+#define POMODORO_HISTORY_FLAG_STOPPED BIT(3)
+/* Last phase of a cycle, whether it ran out or was stopped. */
+#define POMODORO_HISTORY_FLAG_SESSION_END BIT(4)
+
+/*
+ * One finished phase. A phase without SKIPPED or STOPPED ran to its end.
+ * There is no wall clock, so `day` counts 24 h windows of uptime; after a
+ * reset it carries on from the newest stored record.
+ */
+struct pomodoro_history_record {
+    uint16_t day;
+    /* Time actually spent in the phase, pauses excluded. */
+    uint16_t duration_s;
+    uint8_t flags;
+    uint8_t session;
+    uint8_t pauses;
+    uint8_t extends;
+} __packed;
+
+BUILD_ASSERT(sizeof(struct pomodoro_history_record) == 8, "history records are 8 bytes");
+
+/* Running totals for one day, kept up to date as records are added. */
+struct pomodoro_history_day {
+    uint16_t day;
+    uint16_t work_completed;
+    uint16_t work_stopped;
+    uint16_t breaks_taken;
+    uint16_t breaks_skipped;
+    uint16_t pauses;
+    uint16_t extends;
+    uint32_t focus_s;
+    uint32_t break_s;
+};
+
+#if IS_ENABLED(CONFIG_ZMK_POMODORO_HISTORY)
+/*
+ * Stamps the day and appends `record`, overwriting the oldest one when the
+ * ring is full. Cheap enough to call under ctx.lock: flash is only touched
+ * from the Pomodoro queue, once per batch or at the end of a cycle.
+ */
+void pomodoro_history_append(const struct pomodoro_history_record *record);
+
+/* Today's totals without walking the ring. */
+void pomodoro_history_today(struct pomodoro_history_day *day);
+
+/* Records held, at most CONFIG_ZMK_POMODORO_HISTORY_RECORDS. */
+uint32_t pomodoro_history_count(void);
+
+/* The record `age` entries back from the newest one; false past the oldest. */
+bool pomodoro_history_get(uint32_t age, struct pomodoro_history_record *record);
+#else
+static inline void pomodoro_history_append(const struct pomodoro_history_record *record) {
+    ARG_UNUSED(record);
+}
+
+static inline void pomodoro_history_today(struct pomodoro_history_day *day) {
+    *day = (struct pomodoro_history_day){0};
+}
+
+static inline uint32_t pomodoro_history_count(void) { return 0; }
+
+static inline bool pomodoro_history_get(uint32_t age, struct pomodoro_history_record *record) {
+    ARG_UNUSED(age);
+    ARG_UNUSED(record);
+    return false;
+}
+#endif
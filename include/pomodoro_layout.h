@@ -0,0 +1,92 @@
+#pragma once
+
+#include <zephyr/devicetree.h>
+#include <zephyr/sys/util.h>
+
+#include <lvgl.h>
+
+/*
+ * Screen geometry is fixed at build time from the node chosen as
+ * zephyr,display: nice!view is 160x68, the common OLEDs 128x64 and 128x32.
+ * Builds without a chosen display lay out for the nice!view.
+ */
+#if DT_HAS_CHOSEN(zephyr_display)
+#define POMODORO_PANEL_WIDTH DT_PROP(DT_CHOSEN(zephyr_display), width)
+#define POMODORO_PANEL_HEIGHT DT_PROP(DT_CHOSEN(zephyr_display), height)
+#else
+#define POMODORO_PANEL_WIDTH 160
+#define POMODORO_PANEL_HEIGHT 68
+#endif
+
+/* The region the Pomodoro owns: the whole panel, or a full-width widget band. */
+#define POMODORO_VIEW_WIDTH POMODORO_PANEL_WIDTH
+#if IS_ENABLED(CONFIG_ZMK_POMODORO_DISPLAY_WIDGET)
+#define POMODORO_VIEW_HEIGHT CONFIG_ZMK_POMODORO_WIDGET_HEIGHT
+#else
+#define POMODORO_VIEW_HEIGHT POMODORO_PANEL_HEIGHT
+#endif
+
+BUILD_ASSERT(POMODORO_VIEW_WIDTH >= 64 && POMODORO_VIEW_HEIGHT >= 24,
+             "pomodoro display region is too small");
+
+/* A Montserrat size when the build enables it, LVGL's default font otherwise. */
+#if defined(CONFIG_LV_FONT_MONTSERRAT_12)
+#define POMODORO_FONT_SMALL (&lv_font_montserrat_12)
+#else
+#define POMODORO_FONT_SMALL LV_FONT_DEFAULT
+#endif
+
+#if defined(CONFIG_LV_FONT_MONTSERRAT_16)
+#define POMODORO_FONT_NORMAL (&lv_font_montserrat_16)
+#else
+#define POMODORO_FONT_NORMAL LV_FONT_DEFAULT
+#endif
+
+#if defined(CONFIG_LV_FONT_MONTSERRAT_26)
+#define POMODORO_FONT_LARGE (&lv_font_montserrat_26)
+#else
+#define POMODORO_FONT_LARGE LV_FONT_DEFAULT
+#endif
+
+#define POMODORO_HALF_WIDTH (POMODORO_VIEW_WIDTH / 2)
+
+/*
+ * 64 rows and up fit four rows: status and session, the large countdown,
+ * the progress bar, the hint. Shorter regions (128x32, widgets) pack three:
+ * status and countdown, the bar, session and hint.
+ */
+#define POMODORO_LAYOUT_TALL (POMODORO_VIEW_HEIGHT >= 64)
+
+#if POMODORO_LAYOUT_TALL
+#define POMODORO_TOP_HEIGHT 16
+#define POMODORO_TIME_Y POMODORO_TOP_HEIGHT
+#define POMODORO_TIME_HEIGHT 28
+#define POMODORO_HINT_HEIGHT 14
+#define POMODORO_HINT_Y (POMODORO_VIEW_HEIGHT - POMODORO_HINT_HEIGHT)
+/* The bar fills what is left between the countdown and the hint, 1 px clear of both. */
+#define POMODORO_BAR_X 4
+#define POMODORO_BAR_Y (POMODORO_TIME_Y + POMODORO_TIME_HEIGHT + 1)
+#define POMODORO_BAR_HEIGHT (POMODORO_HINT_Y - 1 - POMODORO_BAR_Y)
+#define POMODORO_FONT_TOP POMODORO_FONT_NORMAL
+#define POMODORO_FONT_TIME POMODORO_FONT_LARGE
+#else
+#define POMODORO_BAR_X 0
+#define POMODORO_BAR_HEIGHT 4
+#define POMODORO_TOP_HEIGHT ((POMODORO_VIEW_HEIGHT - POMODORO_BAR_HEIGHT - 2) / 2)
+#define POMODORO_TIME_Y 0
+#define POMODORO_TIME_HEIGHT POMODORO_TOP_HEIGHT
+#define POMODORO_BAR_Y (POMODORO_TOP_HEIGHT + 1)
+#define POMODORO_HINT_HEIGHT POMODORO_TOP_HEIGHT
+#define POMODORO_HINT_Y (POMODORO_VIEW_HEIGHT - POMODORO_HINT_HEIGHT)
+/* The normal font wants 16 rows; a 128x32 top row gets the small one. */
+#if POMODORO_TOP_HEIGHT >= 16
+#define POMODORO_FONT_TOP POMODORO_FONT_NORMAL
+#else
+#define POMODORO_FONT_TOP POMODORO_FONT_SMALL
+#endif
+#define POMODORO_FONT_TIME POMODORO_FONT_TOP
+#endif
+
+#define POMODORO_BAR_WIDTH (POMODORO_VIEW_WIDTH - 2 * POMODORO_BAR_X)
+
+BUILD_ASSERT(POMODORO_BAR_HEIGHT >= 2, "no room for the pomodoro progress bar");
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <zephyr/sys/util.h>
+
+enum pomodoro_reminder_id {
+    POMODORO_REMINDER_STANDUP = 0,
+    POMODORO_REMINDER_HYDRATION,
+    POMODORO_REMINDER_COUNT,
+};
+
+#if IS_ENABLED(CONFIG_ZMK_POMODORO_REMINDERS)
+/* Bit per pomodoro_reminder_id currently due; changes are announced as zmk_pomodoro_reminder_changed. */
+uint32_t pomodoro_reminders_due(void);
+#else
+static inline uint32_t pomodoro_reminders_due(void) { return 0; }
+#endif
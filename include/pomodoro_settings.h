@@ -0,0 +1,47 @@
+#pragma once
+
+#include <errno.h>
+#include <stdint.h>
+
+#include <zephyr/sys/util.h>
+
+#define POMODORO_SETTINGS_VERSION 1
+
+/* What survives a reset: enough to resume the right phase of the right session. */
+struct pomodoro_saved_state {
+    uint8_t version;
+    uint8_t state;
+    uint8_t phase;
+    uint8_t session;
+    uint32_t phase_length_s;
+    uint32_t elapsed_s;
+} __packed;
+
+#if IS_ENABLED(CONFIG_ZMK_POMODORO_PERSIST)
+/*
+ * Queues `state` for the deferred commit. Repeated requests inside the
+ * debounce window collapse into one write, and a state equal to what is
+ * already in flash is never written again.
+ */
+void pomodoro_settings_request_save(const struct pomodoro_saved_state *state);
+
+/* Loads the pomodoro subtree synchronously; -ENOENT when nothing valid was stored. */
+int pomodoro_settings_restore(struct pomodoro_saved_state *state);
+
+/* Flash writes since the last call to pomodoro_settings_reset_write_count(). */
+uint32_t pomodoro_settings_write_count(void);
+void pomodoro_settings_reset_write_count(void);
+#else
+static inline void pomodoro_settings_request_save(const struct pomodoro_saved_state *state) {
+    ARG_UNUSED(state);
+}
+
+static inline int pomodoro_settings_restore(struct pomodoro_saved_state *state) {
+    ARG_UNUSED(state);
+    return -ENOTSUP;
+}
+
+static inline uint32_t pomodoro_settings_write_count(void) { return 0; }
+
+static inline void pomodoro_settings_reset_write_count(void) {}
+#endif
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+
+enum pomodoro_stat_counter {
+    POMODORO_STAT_TICK_WAKEUPS,
+    POMODORO_STAT_DISPLAY_SUBMITS,
+    POMODORO_STAT_DISPLAY_REDRAWS,
+    POMODORO_STAT_DISPLAY_SKIPPED,
+    POMODORO_STAT_INVALIDATED_ROWS,
+    POMODORO_STAT_PHASES,
+    POMODORO_STAT_RENDER_PIXELS,
+    POMODORO_STAT_FLUSHED_ROWS,
+    POMODORO_STAT_COUNTER_COUNT,
+};
+
+enum pomodoro_stat_timing {
+    POMODORO_STAT_LOCK_WAIT,
+    POMODORO_STAT_LOCK_HOLD,
+    POMODORO_STAT_DRAW_LATENCY,
+    POMODORO_STAT_KEY_HANDLER,
+    POMODORO_STAT_TICK,
+    POMODORO_STAT_REDRAW,
+    POMODORO_STAT_WAKE_LATENCY,
+    POMODORO_STAT_RENDER,
+    POMODORO_STAT_TIMING_COUNT,
+};
+
+#if IS_ENABLED(CONFIG_ZMK_POMODORO_STATS)
+void pomodoro_stats_add(enum pomodoro_stat_counter counter, uint32_t value);
+
+/* Durations are measured in hardware cycles and reported in microseconds. */
+void pomodoro_stats_record(enum pomodoro_stat_timing timing, uint32_t cycles);
+
+void pomodoro_stats_reset(void);
+
+/* Value of `counter` since the last reset. */
+uint32_t pomodoro_stats_get(enum pomodoro_stat_counter counter);
+
+/*
+ * The current window as one JSON object, counters raw and timings in us.
+ * Returns the length written, or -ENOSPC if it does not fit in `len`.
+ */
+int pomodoro_stats_json(char *buf, size_t len);
+
+/* Writes the current counters to the log at info level. */
+void pomodoro_stats_log(void);
+
+static inline uint32_t pomodoro_stats_cycles(void) { return k_cycle_get_32(); }
+#else
+static inline void pomodoro_stats_add(enum pomodoro_stat_counter counter, uint32_t value) {
+    ARG_UNUSED(counter);
+    ARG_UNUSED(value);
+}
+
+static inline void pomodoro_stats_record(enum pomodoro_stat_timing timing, uint32_t cycles) {
+    ARG_UNUSED(timing);
+    ARG_UNUSED(cycles);
+}
+
+static inline void pomodoro_stats_reset(void) {}
+
+static inline uint32_t pomodoro_stats_get(enum pomodoro_stat_counter counter) {
+    ARG_UNUSED(counter);
+    return 0;
+}
+
+static inline int pomodoro_stats_json(char *buf, size_t len) {
+    ARG_UNUSED(buf);
+    ARG_UNUSED(len);
+    return -ENOTSUP;
+}
+
+static inline void pomodoro_stats_log(void) {}
+
+static inline uint32_t pomodoro_stats_cycles(void) { return 0; }
+#endif
+
+static inline void pomodoro_stats_inc(enum pomodoro_stat_counter counter) {
+    pomodoro_stats_add(counter, 1);
+}
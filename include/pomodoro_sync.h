@@ -0,0 +1,74 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <zephyr/sys/util.h>
+
+#include "pomodoro.h"
+
+#define POMODORO_SYNC_VERSION 1
+
+#define POMODORO_SYNC_FLAG_ON_BREAK BIT(0)
+#define POMODORO_SYNC_FLAG_RESUME_ON_ANY_KEY BIT(1)
+
+/*
+ * Fixed-size delta sent from the peripheral on transitions only. The
+ * countdown is carried as the time left until the phase end when the packet
+ * was built, so the receiver can extrapolate it against its own clock.
+ */
+struct pomodoro_sync_packet {
+    uint8_t version;
+    uint8_t state;
+    uint8_t session;
+    uint8_t max_sessions;
+    uint8_t flags;
+    uint8_t reserved;
+    uint16_t generation;
+    uint16_t phase_total_s;
+    uint32_t remaining_ms;
+} __packed;
+
+#if IS_ENABLED(CONFIG_ZMK_POMODORO_SYNC)
+/* Bytes handed to the transport since the current session started. */
+uint32_t pomodoro_sync_bytes_sent(void);
+
+/*
+ * Receiver: the last mirrored status extrapolated to now; false until the
+ * first packet. On the central the mirror is also re-raised locally as a
+ * zmk_pomodoro_state_changed event, from the system work queue rather than
+ * the thread that received the packet.
+ */
+bool pomodoro_sync_mirror_status(struct pomodoro_status *status);
+uint32_t pomodoro_sync_mirror_generation(void);
+
+/*
+ * Receiver: marks a forwarded behavior press. The next packet that arrives
+ * closes the measurement as press-to-state-change latency.
+ */
+void pomodoro_sync_note_request(void);
+uint32_t pomodoro_sync_last_latency_ms(void);
+uint32_t pomodoro_sync_max_latency_ms(void);
+
+/* Transport glue, implemented by exactly one of the sync transports. */
+int pomodoro_sync_transport_send(const struct pomodoro_sync_packet *packet);
+void pomodoro_sync_receive(const struct pomodoro_sync_packet *packet);
+
+/* Full state for a receiver that just attached, at one-second resolution. */
+void pomodoro_sync_current_packet(struct pomodoro_sync_packet *packet);
+#else
+static inline uint32_t pomodoro_sync_bytes_sent(void) { return 0; }
+
+static inline bool pomodoro_sync_mirror_status(struct pomodoro_status *status) {
+    ARG_UNUSED(status);
+    return false;
+}
+
+static inline uint32_t pomodoro_sync_mirror_generation(void) { return 0; }
+
+static inline void pomodoro_sync_note_request(void) {}
+
+static inline uint32_t pomodoro_sync_last_latency_ms(void) { return 0; }
+
+static inline uint32_t pomodoro_sync_max_latency_ms(void) { return 0; }
+#endif
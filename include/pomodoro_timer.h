@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Deadline timers multiplexed onto the one pomodoro_clock wakeup. Armed
+ * timers sit in a fixed min-heap keyed by absolute deadline and the clock is
+ * only ever armed for the root, so any number of timers costs one wakeup per
+ * distinct deadline and nothing while none is armed. Handlers run on
+ * pomodoro_work_q() with the timer already disarmed, and may re-arm it.
+ */
+struct pomodoro_timer;
+
+typedef void (*pomodoro_timer_handler_t)(struct pomodoro_timer *timer);
+
+struct pomodoro_timer {
+    pomodoro_timer_handler_t handler;
+    /* pomodoro_clock_now_ms() time the handler is due at. */
+    int64_t deadline_ms;
+    /* Position in the heap, -1 while not armed. */
+    int16_t slot;
+};
+
+#define POMODORO_TIMER_INITIALIZER(fn) {.handler = (fn), .deadline_ms = 0, .slot = -1}
+
+/* Arms or moves `timer`; -ENOMEM when CONFIG_ZMK_POMODORO_TIMER_SLOTS are all armed. */
+int pomodoro_timer_start(struct pomodoro_timer *timer, int64_t deadline_ms);
+void pomodoro_timer_stop(struct pomodoro_timer *timer);
+bool pomodoro_timer_is_armed(const struct pomodoro_timer *timer);
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <zephyr/sys/util.h>
+#include <zephyr/toolchain.h>
+
+/*
+ * Trace events. The values are the wire format read by
+ * scripts/pomo_trace_decode.py: append only, never renumber.
+ */
+enum pomodoro_trace_event {
+    /* A dispatched action; arg is the action | the op it mapped to << 8. */
+    POMODORO_TRACE_ACTION = 1,
+    /* A commit; arg packs state | phase << 4 | session << 8. */
+    POMODORO_TRACE_STATE,
+    /* A phase ran out on time; arg packs the ended phase | session << 8. */
+    POMODORO_TRACE_PHASE_END,
+    /* The phase timer fired; arg is how late, in ms, saturated. */
+    POMODORO_TRACE_TICK,
+    /* A clock wakeup; arg is the number of timers it ran. */
+    POMODORO_TRACE_WAKE,
+    /* A key press switched the countdown to seconds. */
+    POMODORO_TRACE_PEEK,
+    /* A reminder came due or cleared; arg is the due mask. */
+    POMODORO_TRACE_REMINDER,
+    /* A redraw was requested; arg is 1 when forced. */
+    POMODORO_TRACE_DRAW_SUBMIT,
+    /* The display applied a new frame; arg is the pixel rows it dirtied. */
+    POMODORO_TRACE_DRAW,
+    /* A saved phase was restored at boot; arg packs like STATE. */
+    POMODORO_TRACE_RESTORE,
+};
+
+/* Packs state, phase and session the way STATE and RESTORE entries carry them. */
+#define POMODORO_TRACE_STATE_ARG(state, phase, session)                                            \
+    ((uint16_t)(((state)&0xF) | (((phase)&0xF) << 4) | ((session) << 8)))
+
+/*
+ * Eight bytes per entry. `lap` is which pass over the ring wrote the slot,
+ * plus one so a never-written slot reads as stale.
+ */
+struct pomodoro_trace_entry {
+    uint32_t time_ms;
+    uint8_t event;
+    uint8_t lap;
+    uint16_t arg;
+} __packed;
+
+BUILD_ASSERT(sizeof(struct pomodoro_trace_entry) == 8, "trace entries are 8 bytes");
+
+#if IS_ENABLED(CONFIG_ZMK_POMODORO_TRACE)
+/*
+ * Appends an entry stamped with the Pomodoro clock. Lock-free and safe from
+ * any context, ISRs included: a claim is one atomic increment, so tracing
+ * never waits on the code it traces.
+ */
+void pomodoro_trace(enum pomodoro_trace_event event, uint16_t arg);
+
+/* Writes the entries added since the previous flush to the log. */
+void pomodoro_trace_log(void);
+#else
+static inline void pomodoro_trace(enum pomodoro_trace_event event, uint16_t arg) {
+    ARG_UNUSED(event);
+    ARG_UNUSED(arg);
+}
+
+static inline void pomodoro_trace_log(void) {}
+#endif
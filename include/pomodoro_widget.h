@@ -0,0 +1,18 @@
+#pragma once
+
+#include <lvgl.h>
+
+/*
+ * Widget mode (CONFIG_ZMK_POMODORO_DISPLAY_WIDGET): the Pomodoro as one
+ * compact full-width region of a status screen built elsewhere, next to the
+ * battery and connection widgets, in the same style as ZMK's own widgets.
+ * Call the init from the screen's zmk_display_status_screen() and align the
+ * returned object like any other widget.
+ */
+struct zmk_widget_pomodoro {
+    lv_obj_t *obj;
+};
+
+/* -EALREADY on a second widget: the UI state is shared, so there is one per build. */
+int zmk_widget_pomodoro_init(struct zmk_widget_pomodoro *widget, lv_obj_t *parent);
+lv_obj_t *zmk_widget_pomodoro_obj(struct zmk_widget_pomodoro *widget);
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <zephyr/kernel.h>
+
+/*
+ * Queue for every piece of Pomodoro timing and bookkeeping: clock expiry,
+ * settings commits, history flushes and loopback sync. Central builds run no timers and,
+ * like builds without CONFIG_ZMK_POMODORO_WORKQUEUE, use the system work queue.
+ */
+#if !IS_ENABLED(CONFIG_ZMK_POMODORO_WORKQUEUE)
+static inline struct k_work_q *pomodoro_work_q(void) { return &k_sys_work_q; }
+#else
+struct k_work_q *pomodoro_work_q(void);
+#endif
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <zephyr/kernel.h>
+#include <zmk/event_manager.h>
+
+/* Raised when a reminder comes due or is cleared again. */
+struct zmk_pomodoro_reminder_changed {
+    /* Bit per enum pomodoro_reminder_id that is due right now. */
+    uint32_t due;
+};
+
+ZMK_EVENT_DECLARE(zmk_pomodoro_reminder_changed);
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <zephyr/kernel.h>
+#include <zmk/event_manager.h>
+
+#include "pomodoro.h"
+
+/*
+ * Raised once per committed change of the timer, never per tick. Subscribers
+ * derive the countdown from status.phase_end_ms instead of waiting for more
+ * events.
+ */
+struct zmk_pomodoro_state_changed {
+    /* Snapshot at the time of the commit; status.generation orders events. */
+    struct pomodoro_status status;
+};
+
+ZMK_EVENT_DECLARE(zmk_pomodoro_state_changed);
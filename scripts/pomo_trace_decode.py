@@ -0,0 +1,194 @@
+#!/usr/bin/env python3
+"""Rebuild a Pomodoro timeline from `pomo trace` output or a trace log flush.
+
+Reads captured shell or log text from files or stdin. Only lines carrying
+"@TRACE" or "@T" are used, wherever they start, so log prefixes and
+interleaved output are fine. Overlapping dumps are merged by entry index.
+
+    python3 scripts/pomo_trace_decode.py capture.txt
+    python3 scripts/pomo_trace_decode.py --all < capture.txt
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+# Mirrors enum pomodoro_trace_event in include/pomodoro_trace.h.
+EVENTS = {
+    1: "action",
+    2: "state",
+    3: "phase_end",
+    4: "tick",
+    5: "wake",
+    6: "peek",
+    7: "reminder",
+    8: "draw_submit",
+    9: "draw",
+    10: "restore",
+}
+
+# enum pomodoro_action (include/pomodoro.h) and enum pomodoro_op (src/pomodoro.c).
+ACTIONS = ["start", "pause", "stop", "smart", "resume", "break_extend", "break_skip"]
+OPS = ["none", "start", "pause", "resume_work", "end_break", "extend_break", "stop"]
+STATES = ["idle", "work", "break", "paused"]
+PHASES = ["none", "work", "break"]
+REMINDERS = ["standup", "hydration"]
+
+HEADER_RE = re.compile(r"@TRACE v(\d+) first=(\d+) count=(\d+) now=(\d+)")
+LINE_RE = re.compile(r"@T (\d+)((?: (?:[0-9a-f]{16}|-))+)")
+ENTRY = struct.Struct("<IBBH")
+
+
+def name(table, index):
+    return table[index] if 0 <= index < len(table) else f"?{index}"
+
+
+def fmt_ms(ms):
+    sign = "-" if ms < 0 else ""
+    ms = abs(ms)
+    h, rest = divmod(ms, 3600000)
+    m, rest = divmod(rest, 60000)
+    s, ms = divmod(rest, 1000)
+    return f"{sign}{h}:{m:02}:{s:02}.{ms:03}"
+
+
+def unpack_state(arg):
+    return arg & 0xF, (arg >> 4) & 0xF, arg >> 8
+
+
+def describe(event, arg):
+    if event == 1:
+        action, op = arg & 0xFF, arg >> 8
+        return f"{name(ACTIONS, action)} -> {name(OPS, op)}" + (" (ignored)" if op == 0 else "")
+    if event in (2, 10):
+        state, phase, session = unpack_state(arg)
+        return f"{name(STATES, state)}, {name(PHASES, phase)} phase, session {session}"
+    if event == 3:
+        return f"{name(PHASES, arg & 0xFF)} ran out, session {arg >> 8}"
+    if event == 4:
+        return f"{arg} ms late" + (" (saturated)" if arg == 0xFFFF else "")
+    if event == 5:
+        return f"ran {arg} timer(s)"
+    if event == 7:
+        due = [REMINDERS[i] for i in range(len(REMINDERS)) if arg & (1 << i)]
+        return "due: " + (", ".join(due) if due else "none")
+    if event == 8:
+        return "forced" if arg else "countdown"
+    if event == 9:
+        return f"{arg} rows dirty"
+    return ""
+
+
+def parse(stream):
+    """Returns ({index: (time_ms, event, lap, arg) or None}, last header)."""
+    entries = {}
+    header = None
+
+    for text in stream:
+        m = HEADER_RE.search(text)
+        if m:
+            if m.group(1) != "1":
+                sys.exit(f"unsupported trace version {m.group(1)}")
+            header = {k: int(v) for k, v in zip(("first", "count", "now"), m.groups()[1:])}
+            continue
+
+        m = LINE_RE.search(text)
+        if not m:
+            continue
+
+        index = int(m.group(1))
+        for word in m.group(2).split():
+            if word == "-":
+                entries.setdefault(index, None)
+            else:
+                entries[index] = ENTRY.unpack(bytes.fromhex(word))
+            index += 1
+
+    return entries, header
+
+
+def unwrap(times):
+    """Undoes the 32-bit millisecond wrap, assuming entries are in order."""
+    out = []
+    offset = 0
+    prev = None
+    for t in times:
+        if prev is not None and t + offset < prev - (1 << 31):
+            offset += 1 << 32
+        prev = t + offset
+        out.append(prev)
+    return out
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("files", nargs="*", help="captured text (default: stdin)")
+    parser.add_argument("--all", action="store_true",
+                        help="also show unchanged commits, wakeups and display traffic")
+    parser.add_argument("--late-ms", type=int, default=50,
+                        help="flag phase timer fires later than this (default 50)")
+    args = parser.parse_args()
+
+    if args.files:
+        entries, header = {}, None
+        for path in args.files:
+            with open(path, encoding="utf-8", errors="replace") as f:
+                more, h = parse(f)
+            entries.update({k: v for k, v in more.items() if v is not None or k not in entries})
+            header = h or header
+    else:
+        entries, header = parse(sys.stdin)
+
+    if not entries:
+        sys.exit("no trace entries found")
+
+    indices = sorted(entries)
+    valid = [i for i in indices if entries[i] is not None]
+    times = dict(zip(valid, unwrap([entries[i][0] for i in valid])))
+    base = times[valid[0]] if valid else 0
+
+    print(f"entries {indices[0]}..{indices[-1]}, {len(valid)} decoded")
+    if header:
+        print(f"dumped at {fmt_ms(header['now'])} uptime")
+
+    last_index = None
+    last_state = None
+    state_since = None
+    prev_time = base
+
+    for index in indices:
+        if last_index is not None and index != last_index + 1:
+            missing = index - last_index - 1
+            print(f"{'':>14}  ... {missing} entries missing (overwritten, or not in the capture)")
+        last_index = index
+
+        entry = entries[index]
+        if entry is None:
+            print(f"{'':>14}  #{index} overwritten while dumping")
+            continue
+
+        _, event, _, arg = entry
+        now = times[index]
+        note = ""
+
+        if event in (2, 10):
+            state = unpack_state(arg)
+            if state == last_state and not args.all:
+                continue
+            if last_state is not None and state_since is not None:
+                note = f"  [{name(STATES, last_state[0])} lasted {fmt_ms(now - state_since)}]"
+            last_state, state_since = state, now
+        elif event in (5, 8, 9) and not args.all:
+            continue
+        elif event == 4 and arg > args.late_ms:
+            note = "  [LATE]"
+
+        delta = now - prev_time
+        prev_time = now
+        print(f"{fmt_ms(now - base):>14} {delta:+7d}ms  #{index:<6} "
+              f"{EVENTS.get(event, f'?{event}'):<11} {describe(event, arg)}{note}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,4 @@
+#include <zephyr/kernel.h>
+#include <zmk/events/pomodoro_reminder_changed.h>
+
+ZMK_EVENT_IMPL(zmk_pomodoro_reminder_changed);
@@ -2,31 +2,55 @@
 #include <zephyr/init.h>
 #include <zephyr/logging/log.h>
 #include <zephyr/sys/util.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/barrier.h>
+
+#include <string.h>
 
 #include <zmk/event_manager.h>
 #include <zmk/events/position_state_changed.h>
+#include <zmk/events/activity_state_changed.h>
+#include <zmk/events/pomodoro_state_changed.h>
 #include <zmk/display.h>
 
 #include "pomodoro.h"
-#include "pomodoro_display.h"
+#include "pomodoro_clock.h"
+#include "pomodoro_history.h"
+#include "pomodoro_settings.h"
+#include "pomodoro_stats.h"
+#include "pomodoro_sync.h"
+#include "pomodoro_timer.h"
+#include "pomodoro_trace.h"
+#include "pomodoro_workq.h"
 
 LOG_MODULE_REGISTER(pomodoro, CONFIG_ZMK_LOG_LEVEL);
 
 #define POMODORO_WORK_SECONDS POMODORO_DEFAULT_WORK_SECONDS
 #define POMODORO_BREAK_SECONDS POMODORO_DEFAULT_BREAK_SECONDS
-#define POMODORO_MINUTE_CHUNK 60
+
+#if IS_ENABLED(CONFIG_ZMK_POMODORO_COUNTDOWN_ADAPTIVE)
+#define POMODORO_PEEK_MS (CONFIG_ZMK_POMODORO_COUNTDOWN_PEEK_SECONDS * 1000)
+#else
+#define POMODORO_PEEK_MS 0
+#endif
+
+#define POMODORO_KEY_LISTENER                                                                     \
+    (IS_ENABLED(CONFIG_ZMK_POMODORO_RESUME_ON_ANY_KEY) || POMODORO_PEEK_MS > 0)
 
 #if IS_ENABLED(CONFIG_ZMK_SPLIT_ROLE_CENTRAL)
 
-int pomodoro_start(void) { return 0; }
-int pomodoro_pause(void) { return 0; }
-int pomodoro_stop(void) { return 0; }
-int pomodoro_smart(void) { return 0; }
-int pomodoro_resume(void) { return 0; }
-int pomodoro_break_extend(void) { return 0; }
-int pomodoro_break_skip(void) { return 0; }
+int pomodoro_dispatch(enum pomodoro_action action) {
+    ARG_UNUSED(action);
+    return 0;
+}
 
 struct pomodoro_status pomodoro_current_status(void) {
+    struct pomodoro_status mirrored;
+
+    if (pomodoro_sync_mirror_status(&mirrored)) {
+        return mirrored;
+    }
+
     return (struct pomodoro_status){
         .state = POMODORO_STATE_IDLE,
         .session = 0,
@@ -36,9 +60,18 @@ struct pomodoro_status pomodoro_current_status(void) {
         .remaining_seconds = 0,
         .phase_total_seconds = POMODORO_WORK_SECONDS,
         .resume_on_any_key = IS_ENABLED(CONFIG_ZMK_POMODORO_RESUME_ON_ANY_KEY),
+        .show_seconds = true,
+        .generation = 0,
+        .phase_end_ms = 0,
     };
 }
 
+uint32_t pomodoro_status_generation(void) { return pomodoro_sync_mirror_generation(); }
+
+bool pomodoro_status_changed_since(uint32_t generation) {
+    return pomodoro_sync_mirror_generation() != generation;
+}
+
 #else
 
 enum pomodoro_phase {
@@ -53,9 +86,13 @@ struct pomodoro_context {
     enum pomodoro_phase phase;
     uint8_t session;
     uint32_t phase_length_s;
-    uint32_t elapsed_s;
+    /* Folded in at pause, in ms so a pause/resume cycle never drops a partial second. */
+    uint32_t elapsed_ms;
     int64_t phase_started_ms;
-    bool ui_timer_running;
+    int64_t peek_until_ms;
+    /* Per-phase counts for the history record, cleared when the phase is closed. */
+    uint8_t pauses;
+    uint8_t extends;
 };
 
 static struct pomodoro_context ctx = {
@@ -64,386 +101,795 @@ static struct pomodoro_context ctx = {
     .phase = POMODORO_PHASE_NONE,
     .session = 0,
     .phase_length_s = POMODORO_WORK_SECONDS,
-    .elapsed_s = 0,
+    .elapsed_ms = 0,
     .phase_started_ms = 0,
-    .ui_timer_running = false,
 };
 
-static struct pomodoro_status snapshot_locked(void);
-static void schedule_minute_tick_locked(void);
-static void cancel_timers_locked(void);
-static void refresh_display_locked(bool force);
-static void start_ui_timer_locked(void);
+/* Cycle stamp of the current ctx.lock acquisition, only touched while holding it. */
+static uint32_t ctx_locked_at;
+
+static void raise_state_changed(void);
+
+static inline void ctx_lock(void) {
+    uint32_t start = pomodoro_stats_cycles();
+
+    k_mutex_lock(&ctx.lock, K_FOREVER);
+    ctx_locked_at = pomodoro_stats_cycles();
+    pomodoro_stats_record(POMODORO_STAT_LOCK_WAIT, ctx_locked_at - start);
+}
+
+/* Commits made while the lock was held are announced here, outside of it. */
+static inline void ctx_unlock(void) {
+    pomodoro_stats_record(POMODORO_STAT_LOCK_HOLD, pomodoro_stats_cycles() - ctx_locked_at);
+    k_mutex_unlock(&ctx.lock);
+    raise_state_changed();
+}
+
+/*
+ * Everything a pomodoro_status is derived from. The countdown itself is not
+ * stored: readers extrapolate it from phase_started_ms, so the block only
+ * changes on real transitions and not on every tick.
+ */
+struct pomodoro_status_block {
+    enum pomodoro_state state;
+    enum pomodoro_phase phase;
+    uint8_t session;
+    uint32_t phase_length_s;
+    uint32_t elapsed_ms;
+    int64_t phase_started_ms;
+    int64_t peek_until_ms;
+};
+
+/*
+ * Seqlock around the published block. status_seq is odd while a write is in
+ * flight and status_seq / 2 is the generation handed out to readers. Writers
+ * are serialized by ctx.lock; the spinlock only keeps a preempting reader
+ * from ever observing (and spinning on) a half-written block.
+ */
+static atomic_t status_seq = ATOMIC_INIT(0);
+static struct k_spinlock publish_lock;
+static struct pomodoro_status_block published_status = {
+    .state = POMODORO_STATE_IDLE,
+    .phase = POMODORO_PHASE_NONE,
+    .phase_length_s = POMODORO_WORK_SECONDS,
+};
+
+static void schedule_tick_locked(void);
+static void cancel_tick_locked(void);
+static void commit_locked(void);
 
-static struct k_work_delayable minute_tick_work;
-static void minute_tick_cb(struct k_work *work);
+/*
+ * The engine's one timer, armed for the next meaningful deadline only. It
+ * owns every timed phase transition.
+ */
+static void tick_cb(struct pomodoro_timer *timer);
 
-static void ui_timer_cb(struct k_timer *timer);
-K_TIMER_DEFINE(ui_timer, ui_timer_cb, NULL);
+static struct pomodoro_timer tick_timer = POMODORO_TIMER_INITIALIZER(tick_cb);
+
+#if POMODORO_KEY_LISTENER
+enum pomodoro_key_action {
+    POMODORO_KEY_NONE = 0,
+    POMODORO_KEY_SKIP_BREAK,
+    POMODORO_KEY_RESUME,
+    POMODORO_KEY_PEEK,
+};
+
+/*
+ * What a key press would do right now, published by the state machine so the
+ * position listener can bail out with a single atomic load.
+ */
+static atomic_t key_action = ATOMIC_INIT(POMODORO_KEY_NONE);
+#endif
 
 static inline bool is_running(void) {
     return ctx.state == POMODORO_STATE_WORK || ctx.state == POMODORO_STATE_BREAK;
 }
 
+static inline uint32_t status_generation(atomic_val_t seq) { return (uint32_t)seq >> 1; }
+
+/* Generations are the sequence without its in-flight bit: 31 bits, compared modulo. */
+static inline bool generation_newer(uint32_t a, uint32_t b) { return (int32_t)((a - b) << 1) > 0; }
+
 static inline bool is_break_phase(void) { return ctx.phase == POMODORO_PHASE_BREAK; }
 
-static inline uint32_t current_elapsed_locked(void) {
-    if (!is_running()) {
-        return ctx.elapsed_s;
+static inline bool state_is_running(enum pomodoro_state state) {
+    return state == POMODORO_STATE_WORK || state == POMODORO_STATE_BREAK;
+}
+
+static inline uint32_t block_elapsed_ms(const struct pomodoro_status_block *blk, int64_t now) {
+    if (!state_is_running(blk->state)) {
+        return blk->elapsed_ms;
     }
 
-    int64_t now = k_uptime_get();
-    int64_t delta_ms = now - ctx.phase_started_ms;
-    uint32_t delta_s = delta_ms > 0 ? delta_ms / 1000 : 0;
-    uint32_t total = ctx.elapsed_s + delta_s;
-    return MIN(total, ctx.phase_length_s);
+    int64_t delta_ms = now - blk->phase_started_ms;
+    uint64_t total = blk->elapsed_ms + (delta_ms > 0 ? delta_ms : 0);
+    return MIN(total, (uint64_t)blk->phase_length_s * 1000);
 }
 
-static inline uint32_t remaining_locked(void) {
-    uint32_t elapsed = current_elapsed_locked();
-    if (elapsed >= ctx.phase_length_s) {
-        return 0;
+/* Whole seconds elapsed, so the shown second flips exactly when the remaining time crosses it. */
+static inline uint32_t block_elapsed(const struct pomodoro_status_block *blk, int64_t now) {
+    return block_elapsed_ms(blk, now) / 1000;
+}
+
+static void fill_block_locked(struct pomodoro_status_block *blk) {
+    /* Zeroed first so padding compares equal in publish_status_locked(). */
+    memset(blk, 0, sizeof(*blk));
+    blk->state = ctx.state;
+    blk->phase = ctx.phase;
+    blk->session = ctx.session;
+    blk->phase_length_s = ctx.phase_length_s;
+    blk->elapsed_ms = ctx.elapsed_ms;
+    blk->phase_started_ms = ctx.phase_started_ms;
+    blk->peek_until_ms = ctx.peek_until_ms;
+}
+
+/*
+ * Render policy: with the adaptive countdown a running phase is shown in
+ * whole minutes until its final minute or while a key-press peek is active.
+ * Paused and idle screens are static, so they can always afford seconds.
+ */
+static bool block_shows_seconds(const struct pomodoro_status_block *blk, int64_t now) {
+    if (!IS_ENABLED(CONFIG_ZMK_POMODORO_COUNTDOWN_ADAPTIVE) || !state_is_running(blk->state)) {
+        return true;
     }
 
-    return ctx.phase_length_s - elapsed;
+    uint32_t elapsed = block_elapsed(blk, now);
+    return blk->phase_length_s - elapsed <= 60 || now < blk->peek_until_ms;
+}
+
+static inline uint32_t current_elapsed_ms_locked(void) {
+    struct pomodoro_status_block blk;
+
+    fill_block_locked(&blk);
+    return block_elapsed_ms(&blk, pomodoro_clock_now_ms());
+}
+
+/* The absolute deadline; every wakeup and every subscriber counts down to this. */
+static inline int64_t phase_end_ms_locked(void) {
+    return ctx.phase_started_ms + (int64_t)ctx.phase_length_s * 1000 - ctx.elapsed_ms;
 }
 
-static void start_ui_timer_locked(void) {
-    if (!ctx.ui_timer_running) {
-        k_timer_start(&ui_timer, K_SECONDS(1), K_SECONDS(1));
-        ctx.ui_timer_running = true;
+static inline uint32_t remaining_ms_locked(void) {
+    return ctx.phase_length_s * 1000 - current_elapsed_ms_locked();
+}
+
+/*
+ * The engine only wakes for its own deadlines: the end of the phase, and the
+ * end of a key-press peek so the peek can be armed again. Subscribers time
+ * the countdown themselves from the phase end carried by the event.
+ */
+static int64_t next_deadline_locked(void) {
+    int64_t phase_end_ms = phase_end_ms_locked();
+
+    if (POMODORO_PEEK_MS > 0 && ctx.peek_until_ms > pomodoro_clock_now_ms()) {
+        return MIN(ctx.peek_until_ms, phase_end_ms);
     }
+
+    return phase_end_ms;
 }
 
-static void stop_ui_timer_locked(void) {
-    if (ctx.ui_timer_running) {
-        k_timer_stop(&ui_timer);
-        ctx.ui_timer_running = false;
+static void publish_key_action_locked(void) {
+#if POMODORO_KEY_LISTENER
+    enum pomodoro_key_action action = POMODORO_KEY_NONE;
+
+    if (IS_ENABLED(CONFIG_ZMK_POMODORO_RESUME_ON_ANY_KEY) &&
+        (ctx.state == POMODORO_STATE_BREAK ||
+         (ctx.state == POMODORO_STATE_PAUSED && is_break_phase()))) {
+        action = POMODORO_KEY_SKIP_BREAK;
+    } else if (IS_ENABLED(CONFIG_ZMK_POMODORO_RESUME_ON_ANY_KEY) &&
+               ctx.state == POMODORO_STATE_PAUSED) {
+        action = POMODORO_KEY_RESUME;
+    } else if (POMODORO_PEEK_MS > 0 && is_running() && pomodoro_clock_now_ms() >= ctx.peek_until_ms &&
+               remaining_ms_locked() > 60 * 1000) {
+        /* Re-armed by the wakeup that ends the current peek. */
+        action = POMODORO_KEY_PEEK;
     }
+
+    atomic_set(&key_action, action);
+#endif
 }
 
-static void refresh_display_locked(bool force) {
-    struct pomodoro_status status = snapshot_locked();
-    k_mutex_unlock(&ctx.lock);
-    pomodoro_display_update(&status, force);
-    k_mutex_lock(&ctx.lock, K_FOREVER);
+static void publish_status_locked(void) {
+    struct pomodoro_status_block blk;
+
+    fill_block_locked(&blk);
+    if (memcmp(&blk, &published_status, sizeof(blk)) == 0) {
+        return;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&publish_lock);
+    atomic_inc(&status_seq);
+    memcpy(&published_status, &blk, sizeof(blk));
+    atomic_inc(&status_seq);
+    k_spin_unlock(&publish_lock, key);
 }
 
-static void reset_phase_timing_locked(void) {
-    ctx.elapsed_s = 0;
-    ctx.phase_started_ms = k_uptime_get();
+/* Lock-free consistent copy of the published block; returns its generation. */
+static uint32_t read_published_status(struct pomodoro_status_block *blk) {
+    for (;;) {
+        atomic_val_t seq = atomic_get(&status_seq);
+        if (seq & 1) {
+            continue;
+        }
+
+        memcpy(blk, &published_status, sizeof(*blk));
+        barrier_dmem_fence_full();
+
+        if (atomic_get(&status_seq) == seq) {
+            return status_generation(seq);
+        }
+    }
 }
 
-static void start_phase_locked(enum pomodoro_phase phase, bool reset_session) {
-    ctx.phase = phase;
-    ctx.state = (phase == POMODORO_PHASE_WORK) ? POMODORO_STATE_WORK : POMODORO_STATE_BREAK;
-    ctx.phase_length_s =
-        (phase == POMODORO_PHASE_WORK) ? POMODORO_WORK_SECONDS : POMODORO_BREAK_SECONDS;
+/*
+ * Only the folded fields are persisted, so a running phase looks the same on
+ * every tick and only transitions and pause/resume reach the deferred save.
+ */
+static void persist_locked(void) {
+    struct pomodoro_saved_state saved = {
+        .state = ctx.state,
+        .phase = ctx.phase,
+        .session = ctx.session,
+        .phase_length_s = ctx.phase_length_s,
+        .elapsed_s = ctx.elapsed_ms / 1000,
+    };
 
-    if (reset_session) {
-        ctx.session = 1;
-    } else if (ctx.session == 0) {
-        ctx.session = 1;
+    pomodoro_settings_request_save(&saved);
+}
+
+/*
+ * What every committed context must satisfy, whatever sequence of actions
+ * and wakeups led to it. Compiled out unless CONFIG_ASSERT is set.
+ */
+static void check_invariants_locked(void) {
+    __ASSERT(ctx.session <= POMODORO_MAX_SESSIONS, "session %u past %u", ctx.session,
+             POMODORO_MAX_SESSIONS);
+    __ASSERT((ctx.state == POMODORO_STATE_IDLE) == (ctx.phase == POMODORO_PHASE_NONE),
+             "state %d in phase %d", ctx.state, ctx.phase);
+    __ASSERT((ctx.state == POMODORO_STATE_IDLE) == (ctx.session == 0), "session %u in state %d",
+             ctx.session, ctx.state);
+    __ASSERT(ctx.elapsed_ms <= ctx.phase_length_s * 1000, "%u ms into a %u s phase",
+             ctx.elapsed_ms, ctx.phase_length_s);
+    __ASSERT(is_running() == pomodoro_timer_is_armed(&tick_timer), "state %d with tick %sarmed",
+             ctx.state, is_running() ? "not " : "");
+}
+
+/*
+ * Folds the current context into everything derived from it. Subscribers
+ * hear about it from ctx_unlock(), once per generation.
+ */
+static void commit_locked(void) {
+    check_invariants_locked();
+    pomodoro_trace(POMODORO_TRACE_STATE,
+                   POMODORO_TRACE_STATE_ARG(ctx.state, ctx.phase, ctx.session));
+    publish_key_action_locked();
+    publish_status_locked();
+    persist_locked();
+}
+
+/*
+ * Closes the current phase in the history. `flags` only carries how it
+ * ended; the kind and the end of a cycle are derived from the context.
+ */
+static void record_phase_locked(uint8_t flags, uint32_t elapsed_ms) {
+    if (ctx.phase == POMODORO_PHASE_NONE) {
+        return;
     }
 
+    if (is_break_phase()) {
+        flags |= POMODORO_HISTORY_FLAG_BREAK;
+        if (ctx.session >= POMODORO_MAX_SESSIONS) {
+            flags |= POMODORO_HISTORY_FLAG_LONG_BREAK | POMODORO_HISTORY_FLAG_SESSION_END;
+        }
+    }
+    if (flags & POMODORO_HISTORY_FLAG_STOPPED) {
+        flags |= POMODORO_HISTORY_FLAG_SESSION_END;
+    }
+
+    struct pomodoro_history_record record = {
+        .duration_s = MIN(elapsed_ms / 1000, UINT16_MAX),
+        .flags = flags,
+        .session = ctx.session,
+        .pauses = ctx.pauses,
+        .extends = ctx.extends,
+    };
+
+    pomodoro_history_append(&record);
+    ctx.pauses = 0;
+    ctx.extends = 0;
+}
+
+static void reset_phase_timing_locked(void) {
+    ctx.elapsed_ms = 0;
+    ctx.phase_started_ms = pomodoro_clock_now_ms();
+}
+
+static void start_session_locked(void) {
+    /* Restarting from a paused phase abandons it. */
+    record_phase_locked(POMODORO_HISTORY_FLAG_STOPPED, current_elapsed_ms_locked());
+
+    ctx.phase = POMODORO_PHASE_WORK;
+    ctx.state = POMODORO_STATE_WORK;
+    ctx.phase_length_s = POMODORO_WORK_SECONDS;
+    ctx.session = 1;
+    pomodoro_settings_reset_write_count();
+    pomodoro_stats_inc(POMODORO_STAT_PHASES);
+
     reset_phase_timing_locked();
-    start_ui_timer_locked();
-    schedule_minute_tick_locked();
+    schedule_tick_locked();
 }
 
-static void schedule_minute_tick_locked(void) {
+static void schedule_tick_locked(void) {
     if (!is_running()) {
         return;
     }
 
-    uint32_t remaining = remaining_locked();
-    uint32_t delay_s = remaining > POMODORO_MINUTE_CHUNK ? POMODORO_MINUTE_CHUNK : remaining;
-
-    k_work_reschedule(&minute_tick_work, K_SECONDS(MAX(delay_s, 1)));
+    pomodoro_timer_start(&tick_timer, next_deadline_locked());
 }
 
-static void complete_work_locked(void) {
-    ctx.elapsed_s = 0;
-    ctx.phase_started_ms = k_uptime_get();
+static void cancel_tick_locked(void) { pomodoro_timer_stop(&tick_timer); }
+
+/*
+ * Timed transitions start the next phase at the exact end of the previous
+ * one rather than "now", so a late wakeup does not stretch the session and
+ * a long sleep can be replayed phase by phase.
+ */
+static void complete_work_at_locked(int64_t start_ms) {
+    pomodoro_stats_inc(POMODORO_STAT_PHASES);
+    ctx.elapsed_ms = 0;
+    ctx.phase_started_ms = start_ms;
     ctx.phase = POMODORO_PHASE_BREAK;
     ctx.state = POMODORO_STATE_BREAK;
-    ctx.phase_length_s = POMODORO_BREAK_SECONDS;
+    ctx.phase_length_s =
+        ctx.session >= POMODORO_MAX_SESSIONS ? POMODORO_LONG_BREAK_SECONDS : POMODORO_BREAK_SECONDS;
 
-    start_ui_timer_locked();
-    schedule_minute_tick_locked();
+    schedule_tick_locked();
 }
 
-static void complete_break_locked(void) {
+static void complete_break_at_locked(int64_t start_ms) {
     ctx.session++;
 
     if (ctx.session > POMODORO_MAX_SESSIONS) {
         ctx.session = 0;
         ctx.state = POMODORO_STATE_IDLE;
         ctx.phase = POMODORO_PHASE_NONE;
-        ctx.elapsed_s = 0;
+        ctx.elapsed_ms = 0;
         ctx.phase_started_ms = 0;
         ctx.phase_length_s = POMODORO_WORK_SECONDS;
-        cancel_timers_locked();
+        cancel_tick_locked();
         return;
     }
 
+    pomodoro_stats_inc(POMODORO_STAT_PHASES);
     ctx.phase = POMODORO_PHASE_WORK;
     ctx.state = POMODORO_STATE_WORK;
     ctx.phase_length_s = POMODORO_WORK_SECONDS;
-    reset_phase_timing_locked();
-    start_ui_timer_locked();
-    schedule_minute_tick_locked();
+    ctx.elapsed_ms = 0;
+    ctx.phase_started_ms = start_ms;
+    schedule_tick_locked();
 }
 
-static void minute_tick_cb(struct k_work *work) {
-    ARG_UNUSED(work);
-    k_mutex_lock(&ctx.lock, K_FOREVER);
+/* User-initiated: the break ends now, not when it was due. */
+static void complete_break_locked(void) {
+    record_phase_locked(POMODORO_HISTORY_FLAG_SKIPPED, current_elapsed_ms_locked());
+    complete_break_at_locked(pomodoro_clock_now_ms());
+}
 
-    if (!is_running()) {
-        k_mutex_unlock(&ctx.lock);
-        return;
-    }
+/*
+ * Applies every phase end that already passed. Normally that is at most one,
+ * but after the system slept through several deadlines it catches up on all
+ * of them. Returns true if any transition happened.
+ */
+static bool reconcile_locked(void) {
+    bool transitioned = false;
 
-    ctx.elapsed_s = current_elapsed_locked();
+    while (is_running() && remaining_ms_locked() == 0) {
+        int64_t phase_end_ms = phase_end_ms_locked();
 
-    if (remaining_locked() == 0) {
+        record_phase_locked(0, ctx.phase_length_s * 1000);
+        pomodoro_trace(POMODORO_TRACE_PHASE_END, ctx.phase | (ctx.session << 8));
         if (ctx.phase == POMODORO_PHASE_WORK) {
-            complete_work_locked();
+            complete_work_at_locked(phase_end_ms);
         } else {
-            complete_break_locked();
+            complete_break_at_locked(phase_end_ms);
         }
-        refresh_display_locked(true);
-        k_mutex_unlock(&ctx.lock);
+        transitioned = true;
+    }
+
+    return transitioned;
+}
+
+static void tick_locked(void) {
+    if (!is_running()) {
         return;
     }
 
-    schedule_minute_tick_locked();
-    refresh_display_locked(false);
-    k_mutex_unlock(&ctx.lock);
+    if (!reconcile_locked()) {
+        /* Early or peek-end wakeup: nothing to announce, just re-arm. */
+        schedule_tick_locked();
+    }
+
+    commit_locked();
 }
 
-static void cancel_timers_locked(void) {
-    k_work_cancel_delayable(&minute_tick_work);
-    stop_ui_timer_locked();
+static void tick_cb(struct pomodoro_timer *timer) {
+    uint32_t start = pomodoro_stats_cycles();
+    int64_t late_ms = pomodoro_clock_now_ms() - timer->deadline_ms;
+
+    pomodoro_trace(POMODORO_TRACE_TICK, CLAMP(late_ms, 0, UINT16_MAX));
+
+    ctx_lock();
+    tick_locked();
+    ctx_unlock();
+    pomodoro_stats_record(POMODORO_STAT_TICK, pomodoro_stats_cycles() - start);
 }
 
 static void stop_locked(void) {
+    record_phase_locked(POMODORO_HISTORY_FLAG_STOPPED, current_elapsed_ms_locked());
+
     ctx.state = POMODORO_STATE_IDLE;
     ctx.phase = POMODORO_PHASE_NONE;
     ctx.session = 0;
-    ctx.elapsed_s = 0;
+    ctx.elapsed_ms = 0;
     ctx.phase_started_ms = 0;
     ctx.phase_length_s = POMODORO_WORK_SECONDS;
-    cancel_timers_locked();
+    cancel_tick_locked();
 }
 
-static void ui_timer_cb(struct k_timer *timer) {
-    ARG_UNUSED(timer);
-    k_mutex_lock(&ctx.lock, K_FOREVER);
-
-    if (is_running()) {
-        ctx.elapsed_s = current_elapsed_locked();
-        if (remaining_locked() == 0) {
-            if (ctx.phase == POMODORO_PHASE_WORK) {
-                complete_work_locked();
-            } else {
-                complete_break_locked();
-            }
-        }
+static int64_t block_phase_end_ms(const struct pomodoro_status_block *blk) {
+    if (!state_is_running(blk->state)) {
+        return 0;
     }
 
-    refresh_display_locked(false);
-    k_mutex_unlock(&ctx.lock);
+    return blk->phase_started_ms + (int64_t)blk->phase_length_s * 1000 - blk->elapsed_ms;
 }
 
-static struct pomodoro_status snapshot_locked(void) {
-    uint32_t remaining = remaining_locked();
+static struct pomodoro_status status_from_block(const struct pomodoro_status_block *blk,
+                                               uint32_t generation, int64_t now) {
+    uint32_t elapsed = block_elapsed(blk, now);
+    uint32_t remaining = elapsed >= blk->phase_length_s ? 0 : blk->phase_length_s - elapsed;
 
     return (struct pomodoro_status){
-        .state = ctx.state,
-        .session = ctx.session,
+        .state = blk->state,
+        .session = blk->session,
         .max_sessions = POMODORO_MAX_SESSIONS,
-        .on_break = ctx.phase == POMODORO_PHASE_BREAK,
-        .paused = ctx.state == POMODORO_STATE_PAUSED,
+        .on_break = blk->phase == POMODORO_PHASE_BREAK,
+        .paused = blk->state == POMODORO_STATE_PAUSED,
         .remaining_seconds = remaining,
-        .phase_total_seconds = ctx.phase_length_s,
+        .phase_total_seconds = blk->phase_length_s,
         .resume_on_any_key = IS_ENABLED(CONFIG_ZMK_POMODORO_RESUME_ON_ANY_KEY),
+        .show_seconds = block_shows_seconds(blk, now),
+        .generation = generation,
+        .phase_end_ms = block_phase_end_ms(blk),
     };
 }
 
-int pomodoro_start(void) {
-    k_mutex_lock(&ctx.lock, K_FOREVER);
-    if (is_running()) {
-        k_mutex_unlock(&ctx.lock);
-        return 0;
+static atomic_t raised_generation = ATOMIC_INIT(0);
+
+static void raise_state_changed(void) {
+    struct pomodoro_status_block blk;
+    uint32_t generation = read_published_status(&blk);
+
+    /*
+     * The CAS keeps concurrent unlockers from announcing the same generation
+     * twice. Losing it only means another unlocker announced something, maybe
+     * an older generation, so retry for as long as this one is newer.
+     */
+    for (;;) {
+        atomic_val_t raised = atomic_get(&raised_generation);
+
+        if (!generation_newer(generation, (uint32_t)raised)) {
+            return;
+        }
+        if (atomic_cas(&raised_generation, raised, (atomic_val_t)generation)) {
+            break;
+        }
     }
 
-    start_phase_locked(POMODORO_PHASE_WORK, true);
-    refresh_display_locked(true);
-    k_mutex_unlock(&ctx.lock);
-    return 0;
+    raise_zmk_pomodoro_state_changed((struct zmk_pomodoro_state_changed){
+        .status = status_from_block(&blk, generation, pomodoro_clock_now_ms()),
+    });
 }
 
-int pomodoro_pause(void) {
-    k_mutex_lock(&ctx.lock, K_FOREVER);
+/*
+ * Transitions triggered by actions. Each one is a single step applied to the
+ * locked context; the table below decides which one an action maps to.
+ */
+enum pomodoro_op {
+    POMODORO_OP_NONE = 0,
+    POMODORO_OP_START,
+    POMODORO_OP_PAUSE,
+    POMODORO_OP_RESUME_WORK,
+    POMODORO_OP_END_BREAK,
+    POMODORO_OP_EXTEND_BREAK,
+    POMODORO_OP_STOP,
+    POMODORO_OP_COUNT,
+};
 
-    if (is_running()) {
-        ctx.elapsed_s = current_elapsed_locked();
-        ctx.state = POMODORO_STATE_PAUSED;
-        stop_ui_timer_locked();
-        k_work_cancel_delayable(&minute_tick_work);
-        refresh_display_locked(true);
-        k_mutex_unlock(&ctx.lock);
-        return 0;
-    }
+static void op_none_locked(void) {}
 
-    if (ctx.state == POMODORO_STATE_PAUSED) {
-        if (is_break_phase()) {
-            complete_break_locked();
-        } else {
-            ctx.state = POMODORO_STATE_WORK;
-            ctx.phase = POMODORO_PHASE_WORK;
-            ctx.phase_started_ms = k_uptime_get();
-            start_ui_timer_locked();
-            schedule_minute_tick_locked();
-        }
-        refresh_display_locked(true);
-    }
+static void op_pause_locked(void) {
+    ctx.elapsed_ms = current_elapsed_ms_locked();
+    ctx.state = POMODORO_STATE_PAUSED;
+    ctx.pauses = MIN(ctx.pauses + 1, UINT8_MAX);
+    cancel_tick_locked();
+}
 
-    k_mutex_unlock(&ctx.lock);
-    return 0;
+static void op_resume_work_locked(void) {
+    ctx.state = POMODORO_STATE_WORK;
+    ctx.phase_started_ms = pomodoro_clock_now_ms();
+    schedule_tick_locked();
 }
 
-int pomodoro_resume(void) {
-    k_mutex_lock(&ctx.lock, K_FOREVER);
+static void op_extend_break_locked(void) {
+    uint32_t limit_s = CONFIG_ZMK_POMODORO_BREAK_EXTEND_LIMIT_MINUTES * 60;
 
-    if (ctx.state == POMODORO_STATE_PAUSED) {
-        if (is_break_phase()) {
-            complete_break_locked();
-        } else {
-            ctx.state = POMODORO_STATE_WORK;
-            ctx.phase = POMODORO_PHASE_WORK;
-            ctx.phase_started_ms = k_uptime_get();
-            start_ui_timer_locked();
-            schedule_minute_tick_locked();
-        }
-        refresh_display_locked(true);
-    } else if (ctx.state == POMODORO_STATE_BREAK) {
-        complete_break_locked();
-        refresh_display_locked(true);
+    if (ctx.phase_length_s >= limit_s) {
+        return;
     }
 
-    k_mutex_unlock(&ctx.lock);
-    return 0;
+    ctx.phase_length_s = MIN(ctx.phase_length_s + 60, limit_s);
+    ctx.extends = MIN(ctx.extends + 1, UINT8_MAX);
+    schedule_tick_locked();
 }
 
-int pomodoro_stop(void) {
-    k_mutex_lock(&ctx.lock, K_FOREVER);
-    stop_locked();
-    refresh_display_locked(true);
-    k_mutex_unlock(&ctx.lock);
-    return 0;
+static void (*const pomodoro_ops[POMODORO_OP_COUNT])(void) = {
+    [POMODORO_OP_NONE] = op_none_locked,
+    [POMODORO_OP_START] = start_session_locked,
+    [POMODORO_OP_PAUSE] = op_pause_locked,
+    [POMODORO_OP_RESUME_WORK] = op_resume_work_locked,
+    [POMODORO_OP_END_BREAK] = complete_break_locked,
+    [POMODORO_OP_EXTEND_BREAK] = op_extend_break_locked,
+    [POMODORO_OP_STOP] = stop_locked,
+};
+
+/* Rows of the transition table: the pomodoro states, with PAUSED split by phase. */
+enum pomodoro_row {
+    POMODORO_ROW_IDLE = POMODORO_STATE_IDLE,
+    POMODORO_ROW_WORK = POMODORO_STATE_WORK,
+    POMODORO_ROW_BREAK = POMODORO_STATE_BREAK,
+    POMODORO_ROW_PAUSED_WORK = POMODORO_STATE_PAUSED,
+    POMODORO_ROW_PAUSED_BREAK,
+    POMODORO_ROW_COUNT,
+};
+
+#define POMODORO_ACTION_COUNT (POMODORO_ACTION_BREAK_SKIP + 1)
+
+static const uint8_t pomodoro_transitions[POMODORO_ROW_COUNT][POMODORO_ACTION_COUNT] = {
+    [POMODORO_ROW_IDLE] = {
+        [POMODORO_ACTION_START] = POMODORO_OP_START,
+        [POMODORO_ACTION_STOP] = POMODORO_OP_STOP,
+        [POMODORO_ACTION_SMART] = POMODORO_OP_START,
+    },
+    [POMODORO_ROW_WORK] = {
+        [POMODORO_ACTION_PAUSE] = POMODORO_OP_PAUSE,
+        [POMODORO_ACTION_STOP] = POMODORO_OP_STOP,
+        [POMODORO_ACTION_SMART] = POMODORO_OP_PAUSE,
+    },
+    [POMODORO_ROW_BREAK] = {
+        [POMODORO_ACTION_PAUSE] = POMODORO_OP_PAUSE,
+        [POMODORO_ACTION_STOP] = POMODORO_OP_STOP,
+        [POMODORO_ACTION_SMART] = POMODORO_OP_END_BREAK,
+        [POMODORO_ACTION_RESUME] = POMODORO_OP_END_BREAK,
+        [POMODORO_ACTION_BREAK_EXTEND] = POMODORO_OP_EXTEND_BREAK,
+        [POMODORO_ACTION_BREAK_SKIP] = POMODORO_OP_END_BREAK,
+    },
+    [POMODORO_ROW_PAUSED_WORK] = {
+        [POMODORO_ACTION_START] = POMODORO_OP_START,
+        [POMODORO_ACTION_PAUSE] = POMODORO_OP_RESUME_WORK,
+        [POMODORO_ACTION_STOP] = POMODORO_OP_STOP,
+        [POMODORO_ACTION_SMART] = POMODORO_OP_RESUME_WORK,
+        [POMODORO_ACTION_RESUME] = POMODORO_OP_RESUME_WORK,
+    },
+    /* A paused break is never resumed: any way out of it ends the break. */
+    [POMODORO_ROW_PAUSED_BREAK] = {
+        [POMODORO_ACTION_START] = POMODORO_OP_START,
+        [POMODORO_ACTION_PAUSE] = POMODORO_OP_END_BREAK,
+        [POMODORO_ACTION_STOP] = POMODORO_OP_STOP,
+        [POMODORO_ACTION_SMART] = POMODORO_OP_END_BREAK,
+        [POMODORO_ACTION_RESUME] = POMODORO_OP_END_BREAK,
+        [POMODORO_ACTION_BREAK_EXTEND] = POMODORO_OP_EXTEND_BREAK,
+        [POMODORO_ACTION_BREAK_SKIP] = POMODORO_OP_END_BREAK,
+    },
+};
+
+static inline enum pomodoro_row row_locked(void) {
+    return ctx.state + (ctx.state == POMODORO_STATE_PAUSED && is_break_phase());
 }
 
-int pomodoro_smart(void) {
-    k_mutex_lock(&ctx.lock, K_FOREVER);
+int pomodoro_dispatch(enum pomodoro_action action) {
+    if ((unsigned int)action >= POMODORO_ACTION_COUNT) {
+        return -EINVAL;
+    }
 
-    if (ctx.state == POMODORO_STATE_IDLE) {
-        start_phase_locked(POMODORO_PHASE_WORK, true);
-    } else if (ctx.state == POMODORO_STATE_PAUSED) {
-        if (is_break_phase()) {
-            complete_break_locked();
-        } else {
-            ctx.state = POMODORO_STATE_WORK;
-            ctx.phase = POMODORO_PHASE_WORK;
-            ctx.phase_started_ms = k_uptime_get();
-            start_ui_timer_locked();
-            schedule_minute_tick_locked();
-        }
-    } else if (ctx.state == POMODORO_STATE_BREAK) {
-        complete_break_locked();
-    } else {
-        ctx.elapsed_s = current_elapsed_locked();
-        ctx.state = POMODORO_STATE_PAUSED;
-        stop_ui_timer_locked();
-        k_work_cancel_delayable(&minute_tick_work);
+    ctx_lock();
+    uint8_t op = pomodoro_transitions[row_locked()][action];
+    pomodoro_trace(POMODORO_TRACE_ACTION, action | (op << 8));
+    pomodoro_ops[op]();
+    if (op != POMODORO_OP_NONE) {
+        commit_locked();
     }
+    ctx_unlock();
 
-    refresh_display_locked(true);
-    k_mutex_unlock(&ctx.lock);
+    if (op == POMODORO_OP_STOP) {
+        pomodoro_stats_log();
+        pomodoro_trace_log();
+    }
     return 0;
 }
 
-int pomodoro_break_extend(void) {
-    k_mutex_lock(&ctx.lock, K_FOREVER);
+struct pomodoro_status pomodoro_current_status(void) {
+    struct pomodoro_status_block blk;
+    uint32_t generation = read_published_status(&blk);
 
-    if (ctx.phase == POMODORO_PHASE_BREAK &&
-        ctx.phase_length_s < CONFIG_ZMK_POMODORO_BREAK_EXTEND_LIMIT_MINUTES * 60) {
-        ctx.phase_length_s =
-            MIN(ctx.phase_length_s + 60, CONFIG_ZMK_POMODORO_BREAK_EXTEND_LIMIT_MINUTES * 60);
-        if (is_running()) {
-            schedule_minute_tick_locked();
-        }
-        refresh_display_locked(true);
-    }
+    return status_from_block(&blk, generation, pomodoro_clock_now_ms());
+}
 
-    k_mutex_unlock(&ctx.lock);
-    return 0;
+uint32_t pomodoro_status_generation(void) { return status_generation(atomic_get(&status_seq)); }
+
+bool pomodoro_status_changed_since(uint32_t generation) {
+    /* An odd (in-flight) sequence never matches, so it reports a change. */
+    return (uint32_t)atomic_get(&status_seq) != (generation << 1);
 }
 
-int pomodoro_break_skip(void) {
-    k_mutex_lock(&ctx.lock, K_FOREVER);
+#if POMODORO_KEY_LISTENER
+static atomic_t key_pending = ATOMIC_INIT(POMODORO_KEY_NONE);
+
+static void pomodoro_peek(void) {
+    ctx_lock();
 
-    if (ctx.phase == POMODORO_PHASE_BREAK) {
-        complete_break_locked();
-        refresh_display_locked(true);
+    if (is_running()) {
+        pomodoro_trace(POMODORO_TRACE_PEEK, 0);
+        ctx.peek_until_ms = pomodoro_clock_now_ms() + POMODORO_PEEK_MS;
+        schedule_tick_locked();
+        commit_locked();
     }
 
-    k_mutex_unlock(&ctx.lock);
-    return 0;
+    ctx_unlock();
 }
 
-struct pomodoro_status pomodoro_current_status(void) {
-    k_mutex_lock(&ctx.lock, K_FOREVER);
-    struct pomodoro_status status = snapshot_locked();
-    k_mutex_unlock(&ctx.lock);
-    return status;
+static void key_work_handler(struct k_work *work) {
+    ARG_UNUSED(work);
+
+    /* Every entry point re-checks the state under the lock. */
+    switch (atomic_set(&key_pending, POMODORO_KEY_NONE)) {
+    case POMODORO_KEY_SKIP_BREAK:
+        pomodoro_break_skip();
+        break;
+    case POMODORO_KEY_RESUME:
+        pomodoro_resume();
+        break;
+    case POMODORO_KEY_PEEK:
+        pomodoro_peek();
+        break;
+    default:
+        break;
+    }
 }
 
-static int pomodoro_any_key_handler(const zmk_event_t *eh) {
-    if (!IS_ENABLED(CONFIG_ZMK_POMODORO_RESUME_ON_ANY_KEY)) {
-        return ZMK_EV_EVENT_BUBBLE;
+K_WORK_DEFINE(key_work, key_work_handler);
+
+static void pomodoro_any_key(const zmk_event_t *eh) {
+    /* Hot path: most key presses stop at this load. */
+    atomic_val_t action = atomic_get(&key_action);
+    if (action == POMODORO_KEY_NONE) {
+        return;
     }
 
     const struct zmk_position_state_changed *ev = as_zmk_position_state_changed(eh);
     if (ev == NULL || !ev->state) {
-        return ZMK_EV_EVENT_BUBBLE;
+        return;
     }
 
-    k_mutex_lock(&ctx.lock, K_FOREVER);
-    bool in_break = ctx.state == POMODORO_STATE_BREAK || (ctx.state == POMODORO_STATE_PAUSED && is_break_phase());
-    bool in_pause = ctx.state == POMODORO_STATE_PAUSED;
-    k_mutex_unlock(&ctx.lock);
-
-    if (in_break) {
-        pomodoro_break_skip();
-    } else if (in_pause) {
-        pomodoro_resume();
+    if (action == POMODORO_KEY_PEEK) {
+        /* One peek per window; the wakeup at its end arms the next one. */
+        atomic_set(&key_action, POMODORO_KEY_NONE);
     }
 
+    /* The keyscan path never takes ctx.lock: the action runs on the Pomodoro queue. */
+    atomic_set(&key_pending, action);
+    k_work_submit_to_queue(pomodoro_work_q(), &key_work);
+}
+
+static int pomodoro_any_key_handler(const zmk_event_t *eh) {
+    uint32_t start = pomodoro_stats_cycles();
+
+    pomodoro_any_key(eh);
+    pomodoro_stats_record(POMODORO_STAT_KEY_HANDLER, pomodoro_stats_cycles() - start);
     return ZMK_EV_EVENT_BUBBLE;
 }
 
 ZMK_LISTENER(pomodoro_any_key, pomodoro_any_key_handler);
 ZMK_SUBSCRIPTION(pomodoro_any_key, zmk_position_state_changed);
+#endif
+
+#if IS_ENABLED(CONFIG_ZMK_POMODORO_COUNTER_WAKE)
+/*
+ * The counter keeps counting while the kernel timer may not have, so catch up
+ * on anything that expired as soon as the keyboard becomes active again.
+ */
+static int pomodoro_activity_handler(const zmk_event_t *eh) {
+    const struct zmk_activity_state_changed *ev = as_zmk_activity_state_changed(eh);
+    if (ev == NULL || ev->state != ZMK_ACTIVITY_ACTIVE) {
+        return ZMK_EV_EVENT_BUBBLE;
+    }
+
+    pomodoro_clock_kick();
+    return ZMK_EV_EVENT_BUBBLE;
+}
+
+ZMK_LISTENER(pomodoro_activity, pomodoro_activity_handler);
+ZMK_SUBSCRIPTION(pomodoro_activity, zmk_activity_state_changed);
+#endif
+
+/*
+ * Off-time is unknown after a reset, so a phase that was running comes back
+ * paused at the point it was last saved instead of silently running on.
+ */
+static void restore_locked(void) {
+    struct pomodoro_saved_state saved;
+
+    if (pomodoro_settings_restore(&saved) != 0 || saved.state == POMODORO_STATE_IDLE) {
+        return;
+    }
+
+    if (saved.state > POMODORO_STATE_PAUSED || saved.phase == POMODORO_PHASE_NONE ||
+        saved.phase > POMODORO_PHASE_BREAK || saved.session == 0 ||
+        saved.session > POMODORO_MAX_SESSIONS || saved.phase_length_s == 0 ||
+        saved.elapsed_s > saved.phase_length_s) {
+        LOG_WRN("Discarding invalid saved pomodoro state");
+        return;
+    }
+
+    ctx.state = POMODORO_STATE_PAUSED;
+    ctx.phase = saved.phase;
+    ctx.session = saved.session;
+    ctx.phase_length_s = saved.phase_length_s;
+    ctx.elapsed_ms = saved.elapsed_s * 1000;
+    ctx.phase_started_ms = 0;
+
+    publish_key_action_locked();
+    publish_status_locked();
+    pomodoro_trace(POMODORO_TRACE_RESTORE,
+                   POMODORO_TRACE_STATE_ARG(ctx.state, ctx.phase, ctx.session));
+    LOG_INF("Restored pomodoro session %u, %u s into the phase", ctx.session, saved.elapsed_s);
+}
 
 static int pomodoro_init(void) {
-    k_work_init_delayable(&minute_tick_work, minute_tick_cb);
-    struct pomodoro_status status = pomodoro_current_status();
-    pomodoro_display_bootstrap(&status);
+    /* A restored state is announced on unlock, so subscribers start from it. */
+    ctx_lock();
+    restore_locked();
+    ctx_unlock();
     return 0;
 }
 
 SYS_INIT(pomodoro_init, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
 
+#if IS_ENABLED(CONFIG_ZTEST)
+void pomodoro_test_reboot(void) {
+    ctx_lock();
+    cancel_tick_locked();
+    ctx.state = POMODORO_STATE_IDLE;
+    ctx.phase = POMODORO_PHASE_NONE;
+    ctx.session = 0;
+    ctx.elapsed_ms = 0;
+    ctx.phase_started_ms = 0;
+    ctx.phase_length_s = POMODORO_WORK_SECONDS;
+    ctx.pauses = 0;
+    ctx.extends = 0;
+    publish_key_action_locked();
+    publish_status_locked();
+    restore_locked();
+    ctx_unlock();
+}
+#endif
+
 #endif
+
+int pomodoro_start(void) { return pomodoro_dispatch(POMODORO_ACTION_START); }
+int pomodoro_pause(void) { return pomodoro_dispatch(POMODORO_ACTION_PAUSE); }
+int pomodoro_stop(void) { return pomodoro_dispatch(POMODORO_ACTION_STOP); }
+int pomodoro_smart(void) { return pomodoro_dispatch(POMODORO_ACTION_SMART); }
+int pomodoro_resume(void) { return pomodoro_dispatch(POMODORO_ACTION_RESUME); }
+int pomodoro_break_extend(void) { return pomodoro_dispatch(POMODORO_ACTION_BREAK_EXTEND); }
+int pomodoro_break_skip(void) { return pomodoro_dispatch(POMODORO_ACTION_BREAK_SKIP); }
@@ -8,9 +8,13 @@
 #include <zmk/behavior.h>
 
 #include "pomodoro.h"
+#include "pomodoro_sync.h"
 
 LOG_MODULE_DECLARE(pomodoro, CONFIG_ZMK_LOG_LEVEL);
 
+/* Device name bytes a split central's run-behavior payload carries to the peripheral. */
+#define POMODORO_BEHAVIOR_NAME_MAX 8
+
 struct pomodoro_behavior_config {
     enum pomodoro_action action;
 };
@@ -23,24 +27,16 @@ static int pomodoro_behavior_pressed(struct zmk_behavior_binding *binding,
     const struct device *dev = zmk_behavior_get_binding(binding->behavior_dev);
     const struct pomodoro_behavior_config *cfg = dev->config;
 
-    switch (cfg->action) {
-    case POMODORO_ACTION_START:
-        return pomodoro_start();
-    case POMODORO_ACTION_PAUSE:
-        return pomodoro_pause();
-    case POMODORO_ACTION_STOP:
-        return pomodoro_stop();
-    case POMODORO_ACTION_SMART:
-        return pomodoro_smart();
-    case POMODORO_ACTION_RESUME:
-        return pomodoro_resume();
-    case POMODORO_ACTION_BREAK_EXTEND:
-        return pomodoro_break_extend();
-    case POMODORO_ACTION_BREAK_SKIP:
-        return pomodoro_break_skip();
-    default:
-        return ZMK_BEHAVIOR_OPAQUE;
+    /*
+     * Global locality runs this on the central and on every peripheral. The
+     * central's engine calls are stubs, so only the half that owns the timer
+     * acts; the central just times the round trip through the mirror.
+     */
+    if (IS_ENABLED(CONFIG_ZMK_SPLIT_ROLE_CENTRAL)) {
+        pomodoro_sync_note_request();
     }
+
+    return pomodoro_dispatch(cfg->action);
 }
 
 static int pomodoro_behavior_released(struct zmk_behavior_binding *binding,
@@ -51,6 +47,7 @@ static int pomodoro_behavior_released(struct zmk_behavior_binding *binding,
 }
 
 static const struct behavior_driver_api pomodoro_behavior_driver_api = {
+    .locality = BEHAVIOR_LOCALITY_GLOBAL,
     .binding_pressed = pomodoro_behavior_pressed,
     .binding_released = pomodoro_behavior_released,
 };
@@ -66,6 +63,8 @@ static int pomodoro_behavior_init(const struct device *dev) {
     };
 
 #define POMODORO_INST(inst)                                                                       \
+    BUILD_ASSERT(sizeof(DEVICE_DT_NAME(DT_DRV_INST(inst))) - 1 <= POMODORO_BEHAVIOR_NAME_MAX,     \
+                 "Pomodoro behavior names over 8 characters never reach the peripheral");         \
     POMODORO_CFG(inst)                                                                            \
     BEHAVIOR_DT_INST_DEFINE(inst, pomodoro_behavior_init, NULL, NULL,                             \
                             &pomodoro_behavior_config_##inst, POST_KERNEL,                        \
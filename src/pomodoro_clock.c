@@ -0,0 +1,240 @@
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/util.h>
+
+#include "pomodoro_clock.h"
+#include "pomodoro_stats.h"
+#include "pomodoro_workq.h"
+
+LOG_MODULE_DECLARE(pomodoro, CONFIG_ZMK_LOG_LEVEL);
+
+static pomodoro_clock_expiry_t expiry_cb;
+static int64_t armed_deadline_ms;
+
+/* Runs on the Pomodoro queue; the lateness against the deadline is its scheduling latency. */
+static void expiry_work_handler(struct k_work *work) {
+    ARG_UNUSED(work);
+
+    int64_t late_ms = pomodoro_clock_now_ms() - armed_deadline_ms;
+    if (late_ms >= 0) {
+        pomodoro_stats_record(POMODORO_STAT_WAKE_LATENCY, k_ms_to_cyc_floor32(late_ms));
+    }
+
+    if (expiry_cb) {
+        expiry_cb();
+    }
+}
+
+#if IS_ENABLED(CONFIG_ZMK_POMODORO_COUNTER_WAKE)
+
+#include <zephyr/drivers/counter.h>
+
+static const struct device *counter_dev = DEVICE_DT_GET(DT_CHOSEN(zmk_pomodoro_counter));
+
+/*
+ * The counter is usually narrower than 64 bits (24 bits on the nRF RTC), so
+ * reads are folded into a 64-bit total, which needs a read at least once per
+ * wrap. The alarm channel therefore never idles: it is armed for the pending
+ * deadline, clamped to half a wrap, or with nothing pending for a guard half a
+ * wrap out that only reads the counter and re-arms.
+ */
+static struct k_spinlock counter_lock;
+static uint32_t last_ticks;
+static uint64_t total_ticks;
+
+/* Serializes the alarm channel and the pending deadline between threads and the ISR. */
+static struct k_spinlock alarm_lock;
+static bool deadline_pending;
+
+K_WORK_DEFINE(expiry_work, expiry_work_handler);
+
+int64_t pomodoro_clock_now_ms(void) {
+    k_spinlock_key_t key = k_spin_lock(&counter_lock);
+    uint32_t ticks;
+
+    counter_get_value(counter_dev, &ticks);
+    if (ticks >= last_ticks) {
+        total_ticks += ticks - last_ticks;
+    } else {
+        total_ticks += (uint64_t)counter_get_top_value(counter_dev) - last_ticks + ticks + 1;
+    }
+    last_ticks = ticks;
+
+    int64_t now_ms = (total_ticks * 1000) / counter_get_frequency(counter_dev);
+    k_spin_unlock(&counter_lock, key);
+    return now_ms;
+}
+
+static void set_alarm_locked(void);
+
+static void alarm_cb(const struct device *dev, uint8_t chan_id, uint32_t ticks, void *user_data) {
+    ARG_UNUSED(dev);
+    ARG_UNUSED(chan_id);
+    ARG_UNUSED(ticks);
+    ARG_UNUSED(user_data);
+
+    k_spinlock_key_t key = k_spin_lock(&alarm_lock);
+    /* Submits the deadline if it is due; anything else, the wrap guard included, re-arms. */
+    set_alarm_locked();
+    k_spin_unlock(&alarm_lock, key);
+}
+
+static void set_alarm_locked(void) {
+    uint32_t max_ticks = counter_get_top_value(counter_dev) / 2;
+    uint64_t ticks = max_ticks;
+
+    if (deadline_pending) {
+        int64_t delta_ms = armed_deadline_ms - pomodoro_clock_now_ms();
+
+        if (delta_ms <= 0) {
+            deadline_pending = false;
+            k_work_submit_to_queue(pomodoro_work_q(), &expiry_work);
+        } else {
+            ticks = ((uint64_t)delta_ms * counter_get_frequency(counter_dev) + 999) / 1000;
+        }
+    } else {
+        /* Keeps the fold current while idle or paused. */
+        pomodoro_clock_now_ms();
+    }
+
+    struct counter_alarm_cfg cfg = {
+        .callback = alarm_cb,
+        .ticks = CLAMP(ticks, 1, max_ticks),
+        .flags = 0,
+    };
+
+    counter_cancel_channel_alarm(counter_dev, 0);
+    int err = counter_set_channel_alarm(counter_dev, 0, &cfg);
+    if (err) {
+        LOG_ERR("pomodoro counter alarm failed: %d", err);
+    }
+}
+
+void pomodoro_clock_arm(int64_t deadline_ms) {
+    k_spinlock_key_t key = k_spin_lock(&alarm_lock);
+    armed_deadline_ms = deadline_ms;
+    deadline_pending = true;
+    set_alarm_locked();
+    k_spin_unlock(&alarm_lock, key);
+}
+
+void pomodoro_clock_cancel(void) {
+    k_spinlock_key_t key = k_spin_lock(&alarm_lock);
+    deadline_pending = false;
+    /* Back to the wrap guard rather than disarmed. */
+    set_alarm_locked();
+    k_spin_unlock(&alarm_lock, key);
+
+    k_work_cancel(&expiry_work);
+}
+
+void pomodoro_clock_kick(void) { k_work_submit_to_queue(pomodoro_work_q(), &expiry_work); }
+
+int pomodoro_clock_init(pomodoro_clock_expiry_t expiry) {
+    expiry_cb = expiry;
+
+    if (!device_is_ready(counter_dev)) {
+        LOG_ERR("pomodoro counter %s not ready", counter_dev->name);
+        return -ENODEV;
+    }
+
+    int err = counter_start(counter_dev);
+    if (err) {
+        return err;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&alarm_lock);
+    set_alarm_locked();
+    k_spin_unlock(&alarm_lock, key);
+    return 0;
+}
+
+#elif IS_ENABLED(CONFIG_ZMK_POMODORO_CLOCK_VIRTUAL)
+
+/*
+ * Time only moves in pomodoro_clock_advance(), and the expiry callback runs
+ * synchronously in that call, so a host run is deterministic and as fast as
+ * the engine itself.
+ */
+static struct k_spinlock virtual_lock;
+static int64_t virtual_now_ms;
+static bool virtual_armed;
+
+int64_t pomodoro_clock_now_ms(void) {
+    k_spinlock_key_t key = k_spin_lock(&virtual_lock);
+    int64_t now_ms = virtual_now_ms;
+    k_spin_unlock(&virtual_lock, key);
+    return now_ms;
+}
+
+void pomodoro_clock_arm(int64_t deadline_ms) {
+    k_spinlock_key_t key = k_spin_lock(&virtual_lock);
+    armed_deadline_ms = deadline_ms;
+    virtual_armed = true;
+    k_spin_unlock(&virtual_lock, key);
+}
+
+void pomodoro_clock_cancel(void) {
+    k_spinlock_key_t key = k_spin_lock(&virtual_lock);
+    virtual_armed = false;
+    k_spin_unlock(&virtual_lock, key);
+}
+
+void pomodoro_clock_kick(void) {
+    pomodoro_clock_cancel();
+    expiry_work_handler(NULL);
+}
+
+void pomodoro_clock_advance(uint32_t ms) {
+    k_spinlock_key_t key = k_spin_lock(&virtual_lock);
+    int64_t target_ms = virtual_now_ms + ms;
+
+    /* Stop at every deadline on the way, as a real clock would have. */
+    while (virtual_armed && armed_deadline_ms <= target_ms) {
+        virtual_now_ms = MAX(virtual_now_ms, armed_deadline_ms);
+        virtual_armed = false;
+        k_spin_unlock(&virtual_lock, key);
+        expiry_work_handler(NULL);
+        key = k_spin_lock(&virtual_lock);
+    }
+
+    virtual_now_ms = target_ms;
+    k_spin_unlock(&virtual_lock, key);
+}
+
+void pomodoro_clock_jump(uint32_t ms) {
+    k_spinlock_key_t key = k_spin_lock(&virtual_lock);
+    virtual_now_ms += ms;
+    k_spin_unlock(&virtual_lock, key);
+}
+
+int pomodoro_clock_init(pomodoro_clock_expiry_t expiry) {
+    expiry_cb = expiry;
+    return 0;
+}
+
+#else
+
+K_WORK_DELAYABLE_DEFINE(expiry_work, expiry_work_handler);
+
+int64_t pomodoro_clock_now_ms(void) { return k_uptime_get(); }
+
+void pomodoro_clock_arm(int64_t deadline_ms) {
+    armed_deadline_ms = deadline_ms;
+    k_work_reschedule_for_queue(pomodoro_work_q(), &expiry_work, K_TIMEOUT_ABS_MS(deadline_ms));
+}
+
+void pomodoro_clock_cancel(void) { k_work_cancel_delayable(&expiry_work); }
+
+void pomodoro_clock_kick(void) {
+    k_work_reschedule_for_queue(pomodoro_work_q(), &expiry_work, K_NO_WAIT);
+}
+
+int pomodoro_clock_init(pomodoro_clock_expiry_t expiry) {
+    expiry_cb = expiry;
+    return 0;
+}
+
+#endif
@@ -0,0 +1,226 @@
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/display.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/util.h>
+
+#include <string.h>
+
+#include <zmk/display.h>
+
+#include <lvgl.h>
+
+#include "pomodoro_digit_blit.h"
+#include "pomodoro_layout.h"
+
+LOG_MODULE_DECLARE(pomodoro, CONFIG_ZMK_LOG_LEVEL);
+
+#define DISPLAY_NODE DT_CHOSEN(zephyr_display)
+#define PANEL_WIDTH POMODORO_PANEL_WIDTH
+#define BAND_PITCH (PANEL_WIDTH / 8)
+#define CELL_COUNT 5
+#define CELL_WIDTH ((POMODORO_DIGIT_GLYPH_WIDTH + 2) * POMODORO_DIGIT_SCALE)
+
+BUILD_ASSERT(PANEL_WIDTH % 8 == 0, "Digit blit needs a byte-aligned panel width");
+
+/*
+ * 1bpp atlas for '0'-'9' and ':', generated at compile time from segment
+ * masks. Rows are MSB-first: bit 7 is the leftmost pixel of the cell.
+ */
+#define SEG_A BIT(0)
+#define SEG_B BIT(1)
+#define SEG_C BIT(2)
+#define SEG_D BIT(3)
+#define SEG_E BIT(4)
+#define SEG_F BIT(5)
+#define SEG_G BIT(6)
+
+#define SEG_BAR(segs, seg) (((segs) & (seg)) ? 0x7E : 0x00)
+#define SEG_SIDES(segs, left, right)                                                              \
+    ((((segs) & (left)) ? 0xC0 : 0x00) | (((segs) & (right)) ? 0x03 : 0x00))
+
+#define GLYPH(segs)                                                                               \
+    {                                                                                             \
+        SEG_BAR(segs, SEG_A), SEG_BAR(segs, SEG_A), SEG_SIDES(segs, SEG_F, SEG_B),                \
+            SEG_SIDES(segs, SEG_F, SEG_B), SEG_SIDES(segs, SEG_F, SEG_B),                         \
+            SEG_SIDES(segs, SEG_F, SEG_B), SEG_BAR(segs, SEG_G), SEG_BAR(segs, SEG_G),            \
+            SEG_SIDES(segs, SEG_E, SEG_C), SEG_SIDES(segs, SEG_E, SEG_C),                         \
+            SEG_SIDES(segs, SEG_E, SEG_C), SEG_SIDES(segs, SEG_E, SEG_C),                         \
+            SEG_BAR(segs, SEG_D), SEG_BAR(segs, SEG_D),                                           \
+    }
+
+#define GLYPH_COLON_INDEX 10
+
+static const uint8_t glyph_atlas[][POMODORO_DIGIT_GLYPH_HEIGHT] = {
+    GLYPH(SEG_A | SEG_B | SEG_C | SEG_D | SEG_E | SEG_F),
+    GLYPH(SEG_B | SEG_C),
+    GLYPH(SEG_A | SEG_B | SEG_D | SEG_E | SEG_G),
+    GLYPH(SEG_A | SEG_B | SEG_C | SEG_D | SEG_G),
+    GLYPH(SEG_B | SEG_C | SEG_F | SEG_G),
+    GLYPH(SEG_A | SEG_C | SEG_D | SEG_F | SEG_G),
+    GLYPH(SEG_A | SEG_C | SEG_D | SEG_E | SEG_F | SEG_G),
+    GLYPH(SEG_A | SEG_B | SEG_C),
+    GLYPH(SEG_A | SEG_B | SEG_C | SEG_D | SEG_E | SEG_F | SEG_G),
+    GLYPH(SEG_A | SEG_B | SEG_C | SEG_D | SEG_F | SEG_G),
+    {0x00, 0x00, 0x00, 0x18, 0x18, 0x00, 0x00, 0x00, 0x00, 0x18, 0x18, 0x00, 0x00, 0x00},
+};
+
+static const struct device *display_dev = DEVICE_DT_GET(DISPLAY_NODE);
+
+/*
+ * Shadow of the band of panel rows the countdown lives in. Writes always span
+ * the full panel width because line-addressed panels like the ls0xx reject
+ * anything else.
+ */
+static uint8_t band[POMODORO_DIGIT_BLIT_HEIGHT * BAND_PITCH];
+static uint16_t band_y;
+static lv_coord_t cells_x;
+static bool msb_first;
+static bool ink_bit;
+static bool attached;
+/* False while the owner draws the rows itself; see pomodoro_digit_blit_release(). */
+static bool owning;
+
+/* Character currently rendered in each cell; '\0' forces a redraw. */
+static char shown[CELL_COUNT];
+
+static void set_band_pixel(uint16_t x, uint16_t y, bool ink) {
+    uint8_t mask = msb_first ? BIT(7 - (x % 8)) : BIT(x % 8);
+    uint8_t *byte = &band[y * BAND_PITCH + x / 8];
+
+    if (ink == ink_bit) {
+        *byte |= mask;
+    } else {
+        *byte &= ~mask;
+    }
+}
+
+static int glyph_index(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+
+    return c == ':' ? GLYPH_COLON_INDEX : -1;
+}
+
+static void render_cell(int cell, char c) {
+    int index = glyph_index(c);
+    uint16_t x0 = cells_x + cell * CELL_WIDTH;
+
+    for (uint16_t y = 0; y < POMODORO_DIGIT_BLIT_HEIGHT; y++) {
+        uint8_t row = index < 0 ? 0 : glyph_atlas[index][y / POMODORO_DIGIT_SCALE];
+
+        for (uint16_t x = 0; x < CELL_WIDTH && x0 + x < PANEL_WIDTH; x++) {
+            uint16_t gx = x / POMODORO_DIGIT_SCALE;
+            bool ink = gx < POMODORO_DIGIT_GLYPH_WIDTH && (row & BIT(7 - gx));
+            set_band_pixel(x0 + x, y, ink);
+        }
+    }
+}
+
+static uint16_t flush_band(void) {
+    const struct display_buffer_descriptor desc = {
+        .buf_size = sizeof(band),
+        .width = PANEL_WIDTH,
+        .height = POMODORO_DIGIT_BLIT_HEIGHT,
+        .pitch = PANEL_WIDTH,
+    };
+
+    int err = display_write(display_dev, 0, band_y, &desc, band);
+    if (err) {
+        LOG_WRN("pomodoro digit blit failed: %d", err);
+        return 0;
+    }
+
+    return POMODORO_DIGIT_BLIT_HEIGHT;
+}
+
+static void redraw_work_handler(struct k_work *work) {
+    ARG_UNUSED(work);
+
+    for (int i = 0; i < CELL_COUNT; i++) {
+        render_cell(i, shown[i]);
+    }
+    flush_band();
+}
+
+K_WORK_DEFINE(redraw_work, redraw_work_handler);
+
+/*
+ * LVGL repainted (and is about to flush) part of the owner. If that reached
+ * the rows we own it wiped the digits, so queue a full re-blit behind the
+ * current LVGL refresh on the display queue.
+ */
+static void owner_draw_cb(lv_event_t *e) {
+    const lv_area_t *clip = lv_event_get_draw_ctx(e)->clip_area;
+
+    if (!owning || clip->y2 < band_y || clip->y1 >= band_y + POMODORO_DIGIT_BLIT_HEIGHT) {
+        return;
+    }
+    k_work_submit_to_queue(zmk_display_work_q(), &redraw_work);
+}
+
+int pomodoro_digit_blit_attach(lv_obj_t *owner, const lv_area_t *rows) {
+    struct display_capabilities caps;
+
+    if (!device_is_ready(display_dev)) {
+        return -ENODEV;
+    }
+
+    display_get_capabilities(display_dev, &caps);
+    if ((caps.current_pixel_format != PIXEL_FORMAT_MONO01 &&
+         caps.current_pixel_format != PIXEL_FORMAT_MONO10) ||
+        (caps.screen_info & SCREEN_INFO_MONO_VTILED) || caps.x_resolution != PANEL_WIDTH) {
+        LOG_INF("pomodoro digit blit unsupported by display, using LVGL label");
+        return -ENOTSUP;
+    }
+
+    if (rows->y1 < 0 || rows->y1 + POMODORO_DIGIT_BLIT_HEIGHT > caps.y_resolution) {
+        return -EINVAL;
+    }
+
+    /* MONO01 stores white as 1, MONO10 stores black as 1; ink follows the theme. */
+    bool ink_white = lv_color_brightness(lv_obj_get_style_text_color(owner, LV_PART_MAIN)) > 127;
+    ink_bit = ink_white == (caps.current_pixel_format == PIXEL_FORMAT_MONO01);
+    msb_first = caps.screen_info & SCREEN_INFO_MONO_MSB_FIRST;
+
+    band_y = rows->y1;
+    cells_x = MAX(0, (PANEL_WIDTH - CELL_COUNT * CELL_WIDTH) / 2);
+    memset(band, ink_bit ? 0x00 : 0xFF, sizeof(band));
+    memset(shown, 0, sizeof(shown));
+
+    lv_obj_add_event_cb(owner, owner_draw_cb, LV_EVENT_DRAW_MAIN, NULL);
+    attached = true;
+    return 0;
+}
+
+uint16_t pomodoro_digit_blit_show(const char *text) {
+    bool dirty = false;
+    size_t len = strlen(text);
+
+    if (!attached) {
+        return 0;
+    }
+
+    owning = true;
+    for (size_t i = 0; i < CELL_COUNT; i++) {
+        char c = i < len ? text[i] : ' ';
+        if (shown[i] == c) {
+            continue;
+        }
+
+        render_cell(i, c);
+        shown[i] = c;
+        dirty = true;
+    }
+
+    return dirty ? flush_band() : 0;
+}
+
+void pomodoro_digit_blit_release(void) {
+    owning = false;
+    /* Whatever LVGL draws meanwhile is gone from the band, so the next show starts over. */
+    memset(shown, 0, sizeof(shown));
+    k_work_cancel(&redraw_work);
+}
@@ -7,11 +7,24 @@
 
 #include <zmk/display.h>
 #include <zmk/display/status_screen.h>
+#include <zmk/event_manager.h>
+#include <zmk/events/pomodoro_reminder_changed.h>
+#include <zmk/events/pomodoro_state_changed.h>
 
 #include <lvgl.h>
+#if defined(CONFIG_LV_Z_MEM_POOL_SYS_HEAP)
+#include <lvgl_mem.h>
+#endif
 
 #include "pomodoro.h"
-#include "pomodoro_display.h"
+#include "pomodoro_clock.h"
+#include "pomodoro_digit_blit.h"
+#include "pomodoro_display_bench.h"
+#include "pomodoro_layout.h"
+#include "pomodoro_reminders.h"
+#include "pomodoro_stats.h"
+#include "pomodoro_trace.h"
+#include "pomodoro_widget.h"
 
 LOG_MODULE_DECLARE(pomodoro, CONFIG_ZMK_LOG_LEVEL);
 
@@ -19,83 +32,402 @@ LOG_MODULE_DECLARE(pomodoro, CONFIG_ZMK_LOG_LEVEL);
 
 #define POMODORO_WORK_SECONDS POMODORO_DEFAULT_WORK_SECONDS
 
-static lv_obj_t *screen;
-static lv_obj_t *status_label;
-static lv_obj_t *session_label;
-static lv_obj_t *time_label;
-static lv_obj_t *hint_label;
-static lv_obj_t *progress_bg;
-static lv_obj_t *progress_fg;
-
-static struct pomodoro_status cached_state;
-static bool cached_force;
-static bool has_cached_state;
+/*
+ * The whole screen, or the widget's container; NULL until the UI exists. It
+ * is also the only object: every field below is drawn into it by
+ * view_draw_cb() instead of living in a label or bar of its own.
+ */
+static lv_obj_t *root;
+
+enum pomodoro_field {
+    FIELD_STATUS,
+    FIELD_SESSION,
+    FIELD_TIME,
+    FIELD_PROGRESS,
+    FIELD_HINT,
+    FIELD_COUNT,
+};
+
+/* Where a field sits, relative to root, and how its text is set. */
+struct pomodoro_field_layout {
+    lv_area_t area;
+    const lv_font_t *font;
+    lv_text_align_t align;
+};
+
+#define FIELD_TEXT(x1, x2, y, h, f, a)                                                             \
+    {.area = {(x1), (y), (x2), (y) + (h)-1}, .font = (f), .align = LV_TEXT_ALIGN_##a}
+
+/* Fixed at build time for the panel (see pomodoro_layout.h); never recomputed. */
+static const struct pomodoro_field_layout layout[FIELD_COUNT] = {
+    [FIELD_STATUS] = FIELD_TEXT(0, POMODORO_HALF_WIDTH - 1, 0, POMODORO_TOP_HEIGHT,
+                                POMODORO_FONT_TOP, LEFT),
+    [FIELD_PROGRESS] = {.area = {POMODORO_BAR_X, POMODORO_BAR_Y,
+                                 POMODORO_BAR_X + POMODORO_BAR_WIDTH - 1,
+                                 POMODORO_BAR_Y + POMODORO_BAR_HEIGHT - 1}},
+#if POMODORO_LAYOUT_TALL
+    [FIELD_SESSION] = FIELD_TEXT(POMODORO_HALF_WIDTH, POMODORO_VIEW_WIDTH - 1, 0,
+                                 POMODORO_TOP_HEIGHT, POMODORO_FONT_TOP, RIGHT),
+    [FIELD_TIME] = FIELD_TEXT(0, POMODORO_VIEW_WIDTH - 1, POMODORO_TIME_Y, POMODORO_TIME_HEIGHT,
+                              POMODORO_FONT_TIME, CENTER),
+    [FIELD_HINT] = FIELD_TEXT(0, POMODORO_VIEW_WIDTH - 1, POMODORO_HINT_Y, POMODORO_HINT_HEIGHT,
+                              POMODORO_FONT_SMALL, CENTER),
+#else
+    [FIELD_TIME] = FIELD_TEXT(POMODORO_HALF_WIDTH, POMODORO_VIEW_WIDTH - 1, POMODORO_TIME_Y,
+                              POMODORO_TIME_HEIGHT, POMODORO_FONT_TIME, RIGHT),
+    [FIELD_SESSION] = FIELD_TEXT(0, POMODORO_HALF_WIDTH - 1, POMODORO_HINT_Y,
+                                 POMODORO_HINT_HEIGHT, POMODORO_FONT_SMALL, LEFT),
+    [FIELD_HINT] = FIELD_TEXT(POMODORO_HALF_WIDTH, POMODORO_VIEW_WIDTH - 1, POMODORO_HINT_Y,
+                              POMODORO_HINT_HEIGHT, POMODORO_FONT_SMALL, RIGHT),
+#endif
+};
+
+/*
+ * Screen position of root's top-left corner. The full screen never moves; a
+ * widget may be placed after it is built, so the draw pass refreshes this
+ * rather than the per-second path asking LVGL.
+ */
+static lv_coord_t origin_x;
+static lv_coord_t origin_y;
+
+/*
+ * Elapsed seconds at which the bar reaches each pixel for the plan's phase
+ * lengths, at[p] = ceil(p * total / width). Filled once when the UI is built;
+ * an update walks it from the shown fill edge instead of dividing.
+ */
+struct progress_steps {
+    uint32_t total_s;
+    uint16_t at[POMODORO_BAR_WIDTH + 1];
+};
+
+BUILD_ASSERT(MAX(POMODORO_DEFAULT_WORK_SECONDS,
+                 MAX(POMODORO_DEFAULT_BREAK_SECONDS, POMODORO_LONG_BREAK_SECONDS)) <= UINT16_MAX,
+             "progress steps hold phase lengths up to 18 h");
+
+static struct progress_steps progress_steps[] = {
+    {.total_s = POMODORO_DEFAULT_WORK_SECONDS},
+    {.total_s = POMODORO_DEFAULT_BREAK_SECONDS},
+#if POMODORO_LONG_BREAK_SECONDS != POMODORO_DEFAULT_BREAK_SECONDS
+    {.total_s = POMODORO_LONG_BREAK_SECONDS},
+#endif
+};
+
+/*
+ * Everything the draw callback renders. apply_state() builds the next frame,
+ * diffs it against the shown one and invalidates only what differs. Both run
+ * on the display queue, as does the LVGL refresh that reads it.
+ */
+struct pomodoro_frame {
+    char status[8];
+    char session[14];
+    char time[9];
+    char hint[24];
+    lv_coord_t fill_width;
+};
+
+static struct pomodoro_frame shown;
+
+/* The digit blitter is attached to the countdown rows. */
+static bool time_blitted;
+/* It drew the countdown shown now, so the view leaves those rows alone. */
+static bool time_on_blit;
+
 static struct pomodoro_status last_drawn;
 static bool has_drawn;
 
-K_MUTEX_DEFINE(display_state_mutex);
+/*
+ * The ls0xx memory LCD is line addressed, so the cost of an update is the
+ * number of distinct pixel rows pushed, not the area. invalidated_rows is
+ * what a redraw asked LVGL to repaint; LVGL may join those areas into more
+ * rows, so with stats the rows that reached the driver are counted at the
+ * flush as well.
+ */
+#define POMODORO_ROWS_MAX 256
+static uint32_t invalidated_rows[POMODORO_ROWS_MAX / 32];
+static unsigned int last_invalidated_rows;
+
+/* Cycle stamp of the oldest draw request the work item has not picked up yet, 0 if none. */
+static atomic_t draw_requested_at = ATOMIC_INIT(0);
+
+/*
+ * Handoff to the display queue. The engine's published status is already a
+ * sequence-counted slot that never blocks its writer, so the work handler
+ * reads the latest consistent frame straight from pomodoro_current_status()
+ * and intermediate states are skipped for free. Requesters only raise this
+ * flag and submit.
+ */
+static atomic_t draw_force = ATOMIC_INIT(0);
+
 static void apply_state(struct pomodoro_status state, bool force);
+static void schedule_countdown(const struct pomodoro_status *state);
 
 static void pomodoro_display_work_handler(struct k_work *work) {
     ARG_UNUSED(work);
 
-    if (!screen || !zmk_display_is_initialized()) {
-        return;
+    atomic_val_t requested_at = atomic_set(&draw_requested_at, 0);
+    if (requested_at) {
+        pomodoro_stats_record(POMODORO_STAT_DRAW_LATENCY,
+                              pomodoro_stats_cycles() - (uint32_t)requested_at);
     }
 
-    struct pomodoro_status state;
-    bool force;
-
-    k_mutex_lock(&display_state_mutex, K_FOREVER);
-    if (!has_cached_state) {
-        k_mutex_unlock(&display_state_mutex);
+    if (!root || !zmk_display_is_initialized()) {
         return;
     }
-    state = cached_state;
-    force = cached_force;
-    cached_force = false;
-    k_mutex_unlock(&display_state_mutex);
 
+    bool force = atomic_clear(&draw_force);
+    struct pomodoro_status state = pomodoro_current_status();
+
+    uint32_t start = pomodoro_stats_cycles();
     apply_state(state, force);
+    pomodoro_stats_record(POMODORO_STAT_REDRAW, pomodoro_stats_cycles() - start);
+    schedule_countdown(&state);
 }
 
 K_WORK_DEFINE(pomodoro_display_work, pomodoro_display_work_handler);
 
 static void request_draw(bool force) {
-    k_mutex_lock(&display_state_mutex, K_FOREVER);
-    cached_force |= force;
-    has_cached_state = true;
-    k_mutex_unlock(&display_state_mutex);
+    if (force) {
+        atomic_set(&draw_force, 1);
+    }
 
-    if (screen) {
+    if (root) {
+        if (IS_ENABLED(CONFIG_ZMK_POMODORO_STATS)) {
+            atomic_cas(&draw_requested_at, 0, pomodoro_stats_cycles() | 1);
+        }
+        pomodoro_stats_inc(POMODORO_STAT_DISPLAY_SUBMITS);
+        pomodoro_trace(POMODORO_TRACE_DRAW_SUBMIT, force);
         k_work_submit_to_queue(zmk_display_work_q(), &pomodoro_display_work);
     }
 }
 
-void pomodoro_display_update(const struct pomodoro_status *status, bool force) {
-    if (status == NULL) {
+static void countdown_work_handler(struct k_work *work) {
+    ARG_UNUSED(work);
+    request_draw(false);
+}
+
+K_WORK_DELAYABLE_DEFINE(countdown_work, countdown_work_handler);
+
+/*
+ * The countdown is self-timed from the phase end: one redraw at each flip of
+ * the value at the resolution it is rendered at. The adaptive countdown drops
+ * into seconds on its own at the final-minute flip, and back to minutes on
+ * the first per-second redraw after a peek ends.
+ */
+static void schedule_countdown(const struct pomodoro_status *state) {
+    bool running = state->state == POMODORO_STATE_WORK || state->state == POMODORO_STATE_BREAK;
+    int64_t now = pomodoro_clock_now_ms();
+    int64_t remaining_ms = state->phase_end_ms - now;
+
+    if (!running || state->phase_end_ms == 0 || remaining_ms <= 0) {
+        k_work_cancel_delayable(&countdown_work);
         return;
     }
 
-    k_mutex_lock(&display_state_mutex, K_FOREVER);
-    cached_state = *status;
-    k_mutex_unlock(&display_state_mutex);
-    request_draw(force);
+    int64_t step_ms = state->show_seconds ? 1000 : 60000;
+    int64_t next_ms = state->phase_end_ms - ((remaining_ms - 1) / step_ms) * step_ms;
+    k_work_reschedule_for_queue(zmk_display_work_q(), &countdown_work, K_MSEC(next_ms - now));
+}
+
+static bool is_reminder_event(const zmk_event_t *eh) {
+#if IS_ENABLED(CONFIG_ZMK_POMODORO_REMINDERS)
+    return as_zmk_pomodoro_reminder_changed(eh) != NULL;
+#else
+    ARG_UNUSED(eh);
+    return false;
+#endif
+}
+
+static int pomodoro_display_state_listener(const zmk_event_t *eh) {
+    if (as_zmk_pomodoro_state_changed(eh) == NULL && !is_reminder_event(eh)) {
+        return ZMK_EV_EVENT_BUBBLE;
+    }
+
+    /* The handler picks up whatever is newest by the time it runs. */
+    request_draw(true);
+    return ZMK_EV_EVENT_BUBBLE;
+}
+
+ZMK_LISTENER(pomodoro_display, pomodoro_display_state_listener);
+ZMK_SUBSCRIPTION(pomodoro_display, zmk_pomodoro_state_changed);
+#if IS_ENABLED(CONFIG_ZMK_POMODORO_REMINDERS)
+ZMK_SUBSCRIPTION(pomodoro_display, zmk_pomodoro_reminder_changed);
+#endif
+
+static void mark_rows(uint32_t *rows, const lv_area_t *area) {
+    lv_coord_t y_end = MIN(area->y2, POMODORO_ROWS_MAX - 1);
+
+    for (lv_coord_t y = MAX(area->y1, 0); y <= y_end; y++) {
+        rows[y / 32] |= BIT(y % 32);
+    }
+}
+
+static uint16_t take_rows(uint32_t *rows) {
+    uint16_t count = 0;
+
+    for (size_t i = 0; i < POMODORO_ROWS_MAX / 32; i++) {
+        count += __builtin_popcount(rows[i]);
+        rows[i] = 0;
+    }
+
+    return count;
+}
+
+static void reset_shown_state(void) {
+    /* A new object is invalidated whole, so the first frame draws everything anyway. */
+    shown = (struct pomodoro_frame){0};
+    take_rows(invalidated_rows);
+}
+
+static const char *field_text(const struct pomodoro_frame *frame, enum pomodoro_field field) {
+    switch (field) {
+    case FIELD_STATUS:
+        return frame->status;
+    case FIELD_SESSION:
+        return frame->session;
+    case FIELD_TIME:
+        return frame->time;
+    case FIELD_HINT:
+        return frame->hint;
+    default:
+        return NULL;
+    }
+}
+
+/* The field's area in screen coordinates, as LVGL invalidates and clips. */
+static void field_area(enum pomodoro_field field, lv_area_t *area) {
+    *area = layout[field].area;
+    lv_area_move(area, origin_x, origin_y);
+}
+
+static void invalidate_area(const lv_area_t *area) {
+    mark_rows(invalidated_rows, area);
+    lv_obj_invalidate_area(root, area);
 }
 
-void pomodoro_display_bootstrap(const struct pomodoro_status *status) {
-    pomodoro_display_update(status, true);
+static void update_text(enum pomodoro_field field, const struct pomodoro_frame *next) {
+    lv_area_t area;
+
+    if (strcmp(field_text(&shown, field), field_text(next, field)) == 0) {
+        return;
+    }
+
+    /* Fields are sized for their longest text, so the old extent is always inside. */
+    field_area(field, &area);
+    invalidate_area(&area);
 }
 
-static void set_label_text(lv_obj_t *label, const char *text) {
-    if (!label) {
+/* Only the columns between the old and the new fill edge change. */
+static void update_progress(const struct pomodoro_frame *next) {
+    lv_area_t area;
+
+    if (next->fill_width == shown.fill_width) {
         return;
     }
-    lv_label_set_text(label, text);
+
+    field_area(FIELD_PROGRESS, &area);
+    lv_coord_t x1 = area.x1;
+    area.x1 = x1 + MIN(next->fill_width, shown.fill_width);
+    area.x2 = x1 + MAX(next->fill_width, shown.fill_width) - 1;
+    invalidate_area(&area);
+}
+
+static void draw_progress(lv_draw_ctx_t *draw_ctx, const lv_area_t *area, lv_color_t ink) {
+    lv_draw_rect_dsc_t dsc;
+
+    lv_draw_rect_dsc_init(&dsc);
+    dsc.bg_color = ink;
+    dsc.bg_opa = LV_OPA_20;
+    lv_draw_rect(draw_ctx, &dsc, area);
+
+    if (shown.fill_width > 0) {
+        lv_area_t fill = *area;
+
+        fill.x2 = fill.x1 + shown.fill_width - 1;
+        dsc.bg_opa = LV_OPA_COVER;
+        lv_draw_rect(draw_ctx, &dsc, &fill);
+    }
+}
+
+/*
+ * LVGL calls this once per refreshed area after painting root's background.
+ * Most refreshes cover a single field, so the others are skipped before any
+ * glyph is looked at. Each field is clipped to its own area, so a font taller
+ * than its row cannot leave pixels that a later update would not invalidate.
+ */
+static void view_draw_cb(lv_event_t *e) {
+    lv_draw_ctx_t *draw_ctx = lv_event_get_draw_ctx(e);
+    const lv_area_t *clip_area = draw_ctx->clip_area;
+    lv_color_t ink = lv_obj_get_style_text_color(root, LV_PART_MAIN);
+    lv_draw_label_dsc_t label;
+    lv_area_t coords;
+    lv_area_t area;
+    lv_area_t clipped;
+
+    lv_obj_get_coords(root, &coords);
+    origin_x = coords.x1;
+    origin_y = coords.y1;
+
+    lv_draw_label_dsc_init(&label);
+    label.color = ink;
+
+    for (int field = 0; field < FIELD_COUNT; field++) {
+        field_area(field, &area);
+        if (!_lv_area_intersect(&clipped, &area, clip_area)) {
+            continue;
+        }
+
+        draw_ctx->clip_area = &clipped;
+        if (field == FIELD_PROGRESS) {
+            draw_progress(draw_ctx, &area, ink);
+        } else {
+            const char *text = field_text(&shown, field);
+
+            if (!(field == FIELD_TIME && time_on_blit) && text[0] != '\0') {
+                label.font = layout[field].font;
+                label.align = layout[field].align;
+                lv_draw_label(draw_ctx, &label, &area, text, NULL);
+            }
+        }
+    }
+
+    draw_ctx->clip_area = clip_area;
+}
+
+static void build_progress_steps(void) {
+    for (size_t i = 0; i < ARRAY_SIZE(progress_steps); i++) {
+        struct progress_steps *steps = &progress_steps[i];
+
+        for (uint32_t p = 0; p <= POMODORO_BAR_WIDTH; p++) {
+            steps->at[p] = DIV_ROUND_UP(p * steps->total_s, POMODORO_BAR_WIDTH);
+        }
+    }
+}
+
+static lv_coord_t progress_fill(uint32_t total, uint32_t elapsed) {
+    for (size_t i = 0; i < ARRAY_SIZE(progress_steps); i++) {
+        const uint16_t *at = progress_steps[i].at;
+
+        if (progress_steps[i].total_s != total) {
+            continue;
+        }
+
+        /* The edge moves a pixel or two per update, if at all. */
+        lv_coord_t p = CLAMP(shown.fill_width, 0, POMODORO_BAR_WIDTH);
+        while (p < POMODORO_BAR_WIDTH && at[p + 1] <= elapsed) {
+            p++;
+        }
+        while (p > 0 && at[p] > elapsed) {
+            p--;
+        }
+        return p;
+    }
+
+    /* Extended breaks, and a central mirroring another plan. */
+    return total ? (POMODORO_BAR_WIDTH * elapsed) / total : 0;
 }
 
 static void apply_state(struct pomodoro_status state, bool force) {
-    if (!screen) {
+    if (!root) {
         return;
     }
 
@@ -103,150 +435,266 @@ static void apply_state(struct pomodoro_status state, bool force) {
                          state.session != last_drawn.session || state.on_break != last_drawn.on_break;
     bool time_changed =
         !has_drawn || state.remaining_seconds != last_drawn.remaining_seconds ||
-        state.phase_total_seconds != last_drawn.phase_total_seconds || state.paused != last_drawn.paused;
+        state.phase_total_seconds != last_drawn.phase_total_seconds || state.paused != last_drawn.paused ||
+        state.show_seconds != last_drawn.show_seconds;
 
     if (!force && !state_changed && !time_changed) {
+        pomodoro_stats_inc(POMODORO_STAT_DISPLAY_SKIPPED);
         return;
     }
 
-    char status_text[8] = "Idle";
-    char session_text[14];
-    char time_text[9];
-    char hint_text[24] = "";
+    pomodoro_stats_inc(POMODORO_STAT_DISPLAY_REDRAWS);
+
+    struct pomodoro_frame next = {0};
 
     switch (state.state) {
     case POMODORO_STATE_WORK:
-        strcpy(status_text, "Work");
+        strcpy(next.status, "Work");
         break;
     case POMODORO_STATE_BREAK:
-        strcpy(status_text, "Break");
-        strcpy(hint_text, "Resume=Skip");
+        strcpy(next.status, "Break");
+        strcpy(next.hint, "Resume=Skip");
         break;
     case POMODORO_STATE_PAUSED:
-        strcpy(status_text, "Paused");
-        strcpy(hint_text, "Resume/Play");
+        strcpy(next.status, "Paused");
+        strcpy(next.hint, "Resume/Play");
         break;
     case POMODORO_STATE_IDLE:
     default:
-        strcpy(status_text, "Idle");
-        strcpy(hint_text, "Press Start");
+        strcpy(next.status, "Idle");
+        strcpy(next.hint, "Press Start");
         break;
     }
 
     if (state.resume_on_any_key && (state.state == POMODORO_STATE_BREAK || state.state == POMODORO_STATE_PAUSED)) {
-        strcpy(hint_text, "Any key resumes");
+        strcpy(next.hint, "Any key resumes");
+    }
+
+    /* The hint line doubles as the reminder slot; reminder events always force a redraw. */
+    uint32_t due = pomodoro_reminders_due();
+    if (due & BIT(POMODORO_REMINDER_STANDUP)) {
+        strcpy(next.hint, "Stand up!");
+    } else if (due & BIT(POMODORO_REMINDER_HYDRATION)) {
+        strcpy(next.hint, "Drink water");
     }
 
     uint8_t session = state.session;
     if (state.state == POMODORO_STATE_IDLE) {
         session = 0;
     }
-    snprintf(session_text, sizeof(session_text), "Sess %u/%u", session, state.max_sessions);
+    snprintf(next.session, sizeof(next.session), "Sess %u/%u", session, state.max_sessions);
 
     bool is_idle = state.state == POMODORO_STATE_IDLE;
     uint32_t total = state.phase_total_seconds ? state.phase_total_seconds : POMODORO_WORK_SECONDS;
     uint32_t remaining_display = is_idle ? 0 : state.remaining_seconds;
-    uint32_t remaining_for_progress = is_idle ? total : MIN(state.remaining_seconds, total);
+    if (!state.show_seconds) {
+        /* Minute resolution: the bar steps together with the rounded-up minute. */
+        remaining_display = DIV_ROUND_UP(remaining_display, 60) * 60;
+    }
+    uint32_t remaining_for_progress = is_idle ? total : MIN(remaining_display, total);
     uint32_t elapsed = (remaining_for_progress > total) ? 0 : total - remaining_for_progress;
 
-    snprintf(time_text, sizeof(time_text), "%02u:%02u", remaining_display / 60,
-             remaining_display % 60);
-
-    if (state_changed || force) {
-        set_label_text(status_label, status_text);
-        set_label_text(session_label, session_text);
+    if (state.show_seconds) {
+        snprintf(next.time, sizeof(next.time), "%02u:%02u", remaining_display / 60,
+                 remaining_display % 60);
+    } else {
+        snprintf(next.time, sizeof(next.time), "%u min", remaining_display / 60);
     }
 
-    if (time_changed || force) {
-        set_label_text(time_label, time_text);
-        if (!progress_bg || !progress_fg) {
-            goto done;
-        }
-        lv_coord_t bg_width = lv_obj_get_width(progress_bg);
-        if (bg_width == 0) {
-            lv_coord_t parent_width = lv_obj_get_width(lv_obj_get_parent(progress_bg));
-            bg_width = parent_width > 8 ? parent_width - 8 : parent_width;
-            lv_obj_set_width(progress_bg, bg_width);
-            lv_obj_set_height(progress_bg, 8);
-        }
-        lv_coord_t fill_width = (total == 0) ? 0 : (bg_width * elapsed) / total;
-        lv_obj_set_width(progress_fg, fill_width);
-    }
+    next.fill_width = progress_fill(total, elapsed);
+
+    update_text(FIELD_STATUS, &next);
+    update_text(FIELD_SESSION, &next);
+    update_text(FIELD_HINT, &next);
+    update_progress(&next);
 
-    if (hint_text[0] != '\0') {
-        set_label_text(hint_label, hint_text);
-        lv_obj_clear_flag(hint_label, LV_OBJ_FLAG_HIDDEN);
+    /* The atlas has digits and ':' only, so "N min" goes through LVGL. */
+    if (!time_blitted || !state.show_seconds) {
+        if (time_on_blit) {
+            lv_area_t band;
+
+            pomodoro_digit_blit_release();
+            time_on_blit = false;
+            field_area(FIELD_TIME, &band);
+            invalidate_area(&band);
+        }
+        update_text(FIELD_TIME, &next);
     } else {
-        set_label_text(hint_label, "");
-        lv_obj_add_flag(hint_label, LV_OBJ_FLAG_HIDDEN);
+        time_on_blit = true;
+        uint16_t blitted = pomodoro_digit_blit_show(next.time);
+
+        if (blitted > 0) {
+            lv_area_t band;
+
+            field_area(FIELD_TIME, &band);
+            mark_rows(invalidated_rows, &band);
+            /* Written straight to the driver, past the flush hook. */
+            pomodoro_stats_add(POMODORO_STAT_FLUSHED_ROWS, blitted);
+        }
     }
 
-done:
+    shown = next;
+    last_invalidated_rows = take_rows(invalidated_rows);
+    pomodoro_stats_add(POMODORO_STAT_INVALIDATED_ROWS, last_invalidated_rows);
+    pomodoro_trace(POMODORO_TRACE_DRAW, last_invalidated_rows);
+    LOG_DBG("pomodoro redraw: %u rows invalidated", last_invalidated_rows);
     has_drawn = true;
     last_drawn = state;
 }
 
+/* Line heights live in the font data, so a row too short for its font only shows here. */
+static void check_font_fit(void) {
+    static const char *const names[FIELD_COUNT] = {"status", "session", "countdown", NULL, "hint"};
+
+    for (int field = 0; field < FIELD_COUNT; field++) {
+        if (!layout[field].font) {
+            continue;
+        }
+
+        lv_coord_t rows = lv_area_get_height(&layout[field].area);
+        lv_coord_t needed = lv_font_get_line_height(layout[field].font);
+        if (needed > rows) {
+            LOG_WRN("pomodoro %s font is %d px tall, its row %d px; text is clipped",
+                    names[field], needed, rows);
+        }
+    }
+}
+
 static void create_ui(lv_obj_t *parent) {
+    lv_area_t coords;
+
     lv_obj_set_style_bg_opa(parent, LV_OPA_TRANSP, LV_PART_MAIN);
     lv_obj_clear_flag(parent, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_add_event_cb(parent, view_draw_cb, LV_EVENT_DRAW_MAIN, NULL);
+
+    lv_obj_update_layout(parent);
+    lv_obj_get_coords(parent, &coords);
+    origin_x = coords.x1;
+    origin_y = coords.y1;
+
+    build_progress_steps();
+    check_font_fit();
+
+    time_blitted = false;
+    time_on_blit = false;
+#if POMODORO_LAYOUT_TALL && IS_ENABLED(CONFIG_ZMK_POMODORO_DISPLAY_DIGIT_BLIT)
+    BUILD_ASSERT(POMODORO_TIME_HEIGHT == POMODORO_DIGIT_BLIT_HEIGHT,
+                 "the countdown row is the digit blitter's band");
+    /* The countdown row is full-width, so no other field shares the blitter's rows. */
+    time_blitted = pomodoro_digit_blit_attach(parent, &layout[FIELD_TIME].area) == 0;
+#endif
+
+    reset_shown_state();
+}
+
+static uint32_t count_objects(lv_obj_t *obj) {
+    uint32_t count = 1;
+
+    for (uint32_t i = 0; i < lv_obj_get_child_cnt(obj); i++) {
+        count += count_objects(lv_obj_get_child(obj, i));
+    }
+    return count;
+}
+
+static size_t lvgl_heap_used(void) {
+#if LV_MEM_CUSTOM == 0
+    lv_mem_monitor_t mon;
+
+    lv_mem_monitor(&mon);
+    return mon.total_size - mon.free_size;
+#else
+    return 0;
+#endif
+}
+
+#if IS_ENABLED(CONFIG_ZMK_POMODORO_STATS)
+static void (*panel_flush_cb)(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_p);
+static uint32_t flushed_rows[POMODORO_ROWS_MAX / 32];
+
+/* Every area LVGL hands the driver, after it joined the invalidated ones. */
+static void stats_flush_cb(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_p) {
+    mark_rows(flushed_rows, area);
+    panel_flush_cb(drv, area, color_p);
+}
+
+/*
+ * LVGL calls this after every refresh of the display with the time the
+ * render pass took and the pixels it pushed. In widget mode that pass
+ * includes the rest of the status screen, which is the point of measuring it.
+ */
+static void render_monitor_cb(lv_disp_drv_t *drv, uint32_t time_ms, uint32_t px) {
+    ARG_UNUSED(drv);
+    pomodoro_stats_record(POMODORO_STAT_RENDER, k_ms_to_cyc_floor32(time_ms));
+    pomodoro_stats_add(POMODORO_STAT_RENDER_PIXELS, px);
+    pomodoro_stats_add(POMODORO_STAT_FLUSHED_ROWS, take_rows(flushed_rows));
+}
+#endif
 
-    status_label = lv_label_create(parent);
-    lv_obj_align(status_label, LV_ALIGN_TOP_LEFT, 0, 0);
+static void build_ui(lv_obj_t *parent) {
+    size_t heap_before = lvgl_heap_used();
 
-    session_label = lv_label_create(parent);
-    lv_obj_align(session_label, LV_ALIGN_TOP_RIGHT, 0, 0);
+    root = parent;
+    create_ui(root);
+
+    LOG_INF("pomodoro %dx%d %s: %u LVGL objects, %zu bytes of LVGL heap", POMODORO_VIEW_WIDTH,
+            POMODORO_VIEW_HEIGHT, IS_ENABLED(CONFIG_ZMK_POMODORO_DISPLAY_WIDGET) ? "widget" : "screen",
+            count_objects(root), lvgl_heap_used() - heap_before);
+#if defined(CONFIG_LV_Z_MEM_POOL_SYS_HEAP)
+    /* The Zephyr pool has no per-call counter; print its totals instead. */
+    lvgl_print_heap_info(false);
+#endif
 
-    time_label = lv_label_create(parent);
-    lv_obj_set_style_text_font(time_label, lv_theme_get_font_large(parent), LV_PART_MAIN);
-    lv_obj_align(time_label, LV_ALIGN_CENTER, 0, -4);
+#if IS_ENABLED(CONFIG_ZMK_POMODORO_STATS)
+    lv_disp_t *disp = lv_disp_get_default();
+    if (disp && disp->driver->monitor_cb == NULL) {
+        disp->driver->monitor_cb = render_monitor_cb;
+        panel_flush_cb = disp->driver->flush_cb;
+        disp->driver->flush_cb = stats_flush_cb;
+    }
+#endif
 
-    hint_label = lv_label_create(parent);
-    lv_obj_set_style_text_font(hint_label, lv_theme_get_font_small(parent), LV_PART_MAIN);
-    lv_obj_align(hint_label, LV_ALIGN_BOTTOM_MID, 0, -2);
+    request_draw(true);
+}
 
-    lv_coord_t width = lv_obj_get_width(parent);
-    if (width == 0) {
-        lv_disp_t *disp = lv_disp_get_default();
-        width = lv_disp_get_hor_res(disp);
+#if IS_ENABLED(CONFIG_ZMK_POMODORO_DISPLAY_BENCH)
+bool pomodoro_display_bench_apply(const struct pomodoro_status *status, bool from_scratch) {
+    if (!root) {
+        return false;
     }
 
-    progress_bg = lv_obj_create(parent);
-    lv_obj_remove_style_all(progress_bg);
-    lv_obj_set_style_bg_opa(progress_bg, LV_OPA_20, LV_PART_MAIN);
-    lv_obj_set_style_bg_color(progress_bg, lv_color_white(), LV_PART_MAIN);
-    lv_obj_set_size(progress_bg, width - 8, 8);
-    lv_obj_align(progress_bg, LV_ALIGN_BOTTOM_MID, 0, -14);
+    if (from_scratch) {
+        reset_shown_state();
+        has_drawn = false;
+        lv_obj_invalidate(root);
+    }
 
-    progress_fg = lv_obj_create(progress_bg);
-    lv_obj_remove_style_all(progress_fg);
-    lv_obj_set_style_bg_opa(progress_fg, LV_OPA_COVER, LV_PART_MAIN);
-    lv_obj_set_style_bg_color(progress_fg, lv_color_white(), LV_PART_MAIN);
-    lv_obj_set_height(progress_fg, lv_obj_get_height(progress_bg));
-    lv_obj_set_width(progress_fg, 0);
-    lv_obj_align(progress_fg, LV_ALIGN_LEFT_MID, 0, 0);
+    apply_state(*status, from_scratch);
+    return true;
 }
 
-__attribute__((weak)) lv_obj_t *zmk_display_status_screen(void) {
-    screen = lv_obj_create(NULL);
-    create_ui(screen);
+void pomodoro_display_bench_end(void) { request_draw(true); }
+#endif
 
-    if (has_cached_state) {
-        k_work_submit_to_queue(zmk_display_work_q(), &pomodoro_display_work);
-    } else {
-        struct pomodoro_status idle_state = {
-            .state = POMODORO_STATE_IDLE,
-            .session = 0,
-            .max_sessions = POMODORO_MAX_SESSIONS,
-            .on_break = false,
-            .paused = false,
-            .remaining_seconds = 0,
-            .phase_total_seconds = POMODORO_WORK_SECONDS,
-            .resume_on_any_key = IS_ENABLED(CONFIG_ZMK_POMODORO_RESUME_ON_ANY_KEY),
-        };
-        pomodoro_display_update(&idle_state, true);
+#if IS_ENABLED(CONFIG_ZMK_POMODORO_DISPLAY_FULL_SCREEN)
+__attribute__((weak)) lv_obj_t *zmk_display_status_screen(void) {
+    build_ui(lv_obj_create(NULL));
+    return root;
+}
+#else
+int zmk_widget_pomodoro_init(struct zmk_widget_pomodoro *widget, lv_obj_t *parent) {
+    /* The UI state is file-scoped, so there is a single Pomodoro region per build. */
+    if (root) {
+        return -EALREADY;
     }
 
-    return screen;
+    widget->obj = lv_obj_create(parent);
+    lv_obj_remove_style_all(widget->obj);
+    lv_obj_set_size(widget->obj, POMODORO_VIEW_WIDTH, POMODORO_VIEW_HEIGHT);
+    build_ui(widget->obj);
+    return 0;
 }
 
+lv_obj_t *zmk_widget_pomodoro_obj(struct zmk_widget_pomodoro *widget) { return widget->obj; }
+#endif
+
 #endif
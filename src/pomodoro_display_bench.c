@@ -0,0 +1,257 @@
+#include <zephyr/kernel.h>
+#include <zephyr/sys/crc.h>
+#include <zephyr/sys/util.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <zmk/display.h>
+
+#include <lvgl.h>
+
+#include "pomodoro.h"
+#include "pomodoro_display_bench.h"
+
+#define BENCH_MAX_FRAMES 256
+#define BENCH_ROWS_MAX 256
+#define BENCH_WORK_S POMODORO_DEFAULT_WORK_SECONDS
+#define BENCH_BREAK_S POMODORO_DEFAULT_BREAK_SECONDS
+
+/*
+ * The replayed status stream: the first session of the plan as the engine
+ * publishes it, one status per redraw. A segment counts `remaining_s` down
+ * by `step_s` for `frames` frames.
+ */
+struct bench_segment {
+    enum pomodoro_state state;
+    uint8_t session;
+    bool show_seconds;
+    uint16_t total_s;
+    uint16_t remaining_s;
+    uint16_t step_s;
+    uint16_t frames;
+};
+
+static const struct bench_segment stream[] = {
+    /* After boot. */
+    {POMODORO_STATE_IDLE, 0, true, BENCH_WORK_S, 0, 0, 1},
+    /* Started; the first minute by the second. */
+    {POMODORO_STATE_WORK, 1, true, BENCH_WORK_S, BENCH_WORK_S, 1, 60},
+    {POMODORO_STATE_PAUSED, 1, true, BENCH_WORK_S, BENCH_WORK_S - 60, 0, 1},
+    /* Adaptive countdown: whole minutes down to the final one, then seconds. */
+    {POMODORO_STATE_WORK, 1, false, BENCH_WORK_S, BENCH_WORK_S - 60, 60,
+     MAX(BENCH_WORK_S / 60, 2) - 2},
+    {POMODORO_STATE_WORK, 1, true, BENCH_WORK_S, 60, 1, 60},
+    {POMODORO_STATE_BREAK, 1, true, BENCH_BREAK_S, BENCH_BREAK_S, 1, 60},
+    /* Stopped. */
+    {POMODORO_STATE_IDLE, 0, true, BENCH_WORK_S, 0, 0, 1},
+};
+
+static struct pomodoro_display_bench_frame frames[BENCH_MAX_FRAMES];
+static uint32_t frame_count;
+static int bench_error;
+static K_SEM_DEFINE(bench_done, 0, 1);
+
+static void (*live_flush_cb)(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_p);
+static uint32_t flush_crc;
+static uint32_t flush_px;
+static uint32_t flush_rows[BENCH_ROWS_MAX / 32];
+
+/*
+ * Folds every buffer LVGL hands the driver into a running CRC, then passes it
+ * on. Ports that pack mono panels through set_px_cb hand over one bit per
+ * pixel rather than an lv_color_t.
+ */
+static void bench_flush_cb(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_p) {
+    uint32_t px = lv_area_get_size(area);
+    size_t bytes = drv->set_px_cb ? DIV_ROUND_UP(px, 8) : px * sizeof(lv_color_t);
+
+    flush_crc = crc32_ieee_update(flush_crc, (const uint8_t *)area, sizeof(*area));
+    flush_crc = crc32_ieee_update(flush_crc, (const uint8_t *)color_p, bytes);
+    flush_px += px;
+
+    for (lv_coord_t y = MAX(area->y1, 0); y <= MIN(area->y2, BENCH_ROWS_MAX - 1); y++) {
+        flush_rows[y / 32] |= BIT(y % 32);
+    }
+
+    live_flush_cb(drv, area, color_p);
+}
+
+static uint16_t take_flushed_rows(void) {
+    uint16_t rows = 0;
+
+    for (size_t i = 0; i < ARRAY_SIZE(flush_rows); i++) {
+        rows += __builtin_popcount(flush_rows[i]);
+        flush_rows[i] = 0;
+    }
+    return rows;
+}
+
+/* What the next refresh will redraw; LVGL only joins the areas once it starts. */
+static uint32_t invalidated_px(const lv_disp_t *disp) {
+    uint32_t px = 0;
+
+    for (uint16_t i = 0; i < disp->inv_p; i++) {
+        if (!disp->inv_area_joined[i]) {
+            px += lv_area_get_size(&disp->inv_areas[i]);
+        }
+    }
+    return px;
+}
+
+static struct pomodoro_status bench_status(const struct bench_segment *seg, uint16_t i) {
+    return (struct pomodoro_status){
+        .state = seg->state,
+        .session = seg->session,
+        .max_sessions = POMODORO_MAX_SESSIONS,
+        .on_break = seg->state == POMODORO_STATE_BREAK,
+        .paused = seg->state == POMODORO_STATE_PAUSED,
+        .remaining_seconds = seg->remaining_s - i * seg->step_s,
+        .phase_total_seconds = seg->total_s,
+        .show_seconds = seg->show_seconds,
+    };
+}
+
+static bool bench_frame(lv_disp_t *disp, const struct pomodoro_status *status) {
+    struct pomodoro_display_bench_frame *frame = &frames[frame_count];
+    uint32_t start = k_cycle_get_32();
+
+    if (!pomodoro_display_bench_apply(status, frame_count == 0)) {
+        return false;
+    }
+    frame->apply_cyc = k_cycle_get_32() - start;
+    frame->invalidated_px = invalidated_px(disp);
+
+    flush_crc = 0;
+    flush_px = 0;
+    start = k_cycle_get_32();
+    lv_refr_now(disp);
+    frame->render_cyc = k_cycle_get_32() - start;
+
+    frame->flushed_px = flush_px;
+    frame->flushed_rows = take_flushed_rows();
+    frame->crc = flush_crc;
+    frame_count++;
+    return true;
+}
+
+/* Runs the whole replay on the display queue, which owns LVGL; live redraws wait behind it. */
+static void bench_work_handler(struct k_work *work) {
+    ARG_UNUSED(work);
+    lv_disp_t *disp = lv_disp_get_default();
+
+    frame_count = 0;
+    bench_error = 0;
+
+    if (!disp || !zmk_display_is_initialized()) {
+        bench_error = -ENODEV;
+        k_sem_give(&bench_done);
+        return;
+    }
+
+    live_flush_cb = disp->driver->flush_cb;
+    disp->driver->flush_cb = bench_flush_cb;
+    take_flushed_rows();
+
+    for (size_t s = 0; s < ARRAY_SIZE(stream) && !bench_error; s++) {
+        for (uint16_t i = 0; i < stream[s].frames && frame_count < BENCH_MAX_FRAMES; i++) {
+            struct pomodoro_status status = bench_status(&stream[s], i);
+
+            if (!bench_frame(disp, &status)) {
+                bench_error = -ENODEV;
+                break;
+            }
+        }
+    }
+
+    disp->driver->flush_cb = live_flush_cb;
+    pomodoro_display_bench_end();
+    k_sem_give(&bench_done);
+}
+
+K_WORK_DEFINE(bench_work, bench_work_handler);
+
+int pomodoro_display_bench_run(const struct pomodoro_display_bench_frame **replay) {
+    k_sem_reset(&bench_done);
+    k_work_submit_to_queue(zmk_display_work_q(), &bench_work);
+    if (k_sem_take(&bench_done, K_SECONDS(60)) != 0) {
+        return -ETIMEDOUT;
+    }
+
+    if (bench_error || frame_count == 0) {
+        return bench_error ? bench_error : -ENODEV;
+    }
+
+    *replay = frames;
+    return frame_count;
+}
+
+uint32_t pomodoro_display_bench_crc(const struct pomodoro_display_bench_frame *replay,
+                                    size_t count) {
+    uint32_t crc = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        crc = crc32_ieee_update(crc, (const uint8_t *)&replay[i].crc, sizeof(replay[i].crc));
+    }
+    return crc;
+}
+
+#if IS_ENABLED(CONFIG_SHELL)
+#include <zephyr/shell/shell.h>
+
+static int cmd_bench(const struct shell *sh, size_t argc, char **argv) {
+    const struct pomodoro_display_bench_frame *replay;
+    uint64_t apply_total = 0, render_total = 0;
+    uint32_t apply_max = 0, render_max = 0, rows_total = 0;
+    int count = pomodoro_display_bench_run(&replay);
+
+    if (count == -ETIMEDOUT) {
+        shell_error(sh, "display bench did not finish");
+        return count;
+    }
+
+    if (count < 0) {
+        shell_error(sh, "no Pomodoro UI to benchmark (%d)", count);
+        return -ENODEV;
+    }
+
+    shell_print(sh, "frame apply_us render_us  inv_px flush_px rows      crc");
+    for (int i = 0; i < count; i++) {
+        const struct pomodoro_display_bench_frame *frame = &replay[i];
+
+        shell_print(sh, "%5u %8u %9u %7u %8u %4u %08x", i,
+                    k_cyc_to_us_floor32(frame->apply_cyc), k_cyc_to_us_floor32(frame->render_cyc),
+                    frame->invalidated_px, frame->flushed_px, frame->flushed_rows, frame->crc);
+        apply_total += frame->apply_cyc;
+        render_total += frame->render_cyc;
+        apply_max = MAX(apply_max, frame->apply_cyc);
+        render_max = MAX(render_max, frame->render_cyc);
+        rows_total += frame->flushed_rows;
+    }
+
+    uint32_t crc = pomodoro_display_bench_crc(replay, count);
+
+    shell_print(sh,
+                "%u frames: apply mean %u us max %u us, render mean %u us max %u us, %u rows "
+                "flushed, crc %08x",
+                count, k_cyc_to_us_floor32((uint32_t)(apply_total / count)),
+                k_cyc_to_us_floor32(apply_max),
+                k_cyc_to_us_floor32((uint32_t)(render_total / count)),
+                k_cyc_to_us_floor32(render_max), rows_total, crc);
+
+    if (argc > 1) {
+        uint32_t golden = strtoul(argv[1], NULL, 16);
+
+        if (crc != golden) {
+            shell_error(sh, "crc %08x differs from golden %08x", crc, golden);
+            return -EIO;
+        }
+        shell_print(sh, "matches golden crc");
+    }
+    return 0;
+}
+
+SHELL_SUBCMD_ADD((pomo), bench, NULL,
+                 "Replay a session through the display, timing each frame: [golden crc]",
+                 cmd_bench, 1, 1);
+#endif
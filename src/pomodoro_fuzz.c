@@ -0,0 +1,298 @@
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+
+#include <stdlib.h>
+
+#include "pomodoro.h"
+#include "pomodoro_clock.h"
+#include "pomodoro_fuzz.h"
+
+#define FUZZ_ACTION_COUNT (POMODORO_ACTION_BREAK_SKIP + 1)
+#define FUZZ_WORK_MS (POMODORO_DEFAULT_WORK_SECONDS * 1000LL)
+
+#define FUZZ_EXTEND_LIMIT_S (CONFIG_ZMK_POMODORO_BREAK_EXTEND_LIMIT_MINUTES * 60)
+
+/*
+ * What the engine must be after every step, worked out on its own from the
+ * actions and time jumps fed to it: the transition table as documented and
+ * the phase plan, never read back from the engine.
+ */
+struct fuzz_model {
+    enum pomodoro_state state;
+    bool on_break;
+    uint8_t session;
+    uint32_t phase_length_s;
+    /* While running. */
+    int64_t phase_end_ms;
+    /* While paused. */
+    uint32_t left_ms;
+};
+
+static uint32_t xorshift32(uint32_t *state) {
+    uint32_t x = *state;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+static bool is_running_state(enum pomodoro_state state) {
+    return state == POMODORO_STATE_WORK || state == POMODORO_STATE_BREAK;
+}
+
+static void model_stop(struct fuzz_model *model) {
+    *model = (struct fuzz_model){
+        .state = POMODORO_STATE_IDLE,
+        .phase_length_s = POMODORO_DEFAULT_WORK_SECONDS,
+    };
+}
+
+static void model_start_work(struct fuzz_model *model, uint8_t session, int64_t start_ms) {
+    *model = (struct fuzz_model){
+        .state = POMODORO_STATE_WORK,
+        .session = session,
+        .phase_length_s = POMODORO_DEFAULT_WORK_SECONDS,
+        .phase_end_ms = start_ms + FUZZ_WORK_MS,
+    };
+}
+
+/* The break ends now: the next session's work, or idle after the last one. */
+static void model_end_break(struct fuzz_model *model, int64_t now_ms) {
+    if (model->session >= POMODORO_MAX_SESSIONS) {
+        model_stop(model);
+    } else {
+        model_start_work(model, model->session + 1, now_ms);
+    }
+}
+
+static void model_pause(struct fuzz_model *model, int64_t now_ms) {
+    model->left_ms = model->phase_end_ms - now_ms;
+    model->phase_end_ms = 0;
+    model->state = POMODORO_STATE_PAUSED;
+}
+
+static void model_resume_work(struct fuzz_model *model, int64_t now_ms) {
+    model->phase_end_ms = now_ms + model->left_ms;
+    model->left_ms = 0;
+    model->state = POMODORO_STATE_WORK;
+}
+
+static void model_extend_break(struct fuzz_model *model) {
+    if (model->phase_length_s >= FUZZ_EXTEND_LIMIT_S) {
+        return;
+    }
+
+    uint32_t added_s = MIN(model->phase_length_s + 60, FUZZ_EXTEND_LIMIT_S) - model->phase_length_s;
+
+    model->phase_length_s += added_s;
+    if (model->state == POMODORO_STATE_PAUSED) {
+        model->left_ms += added_s * 1000;
+    } else {
+        model->phase_end_ms += added_s * 1000LL;
+    }
+}
+
+/*
+ * One action, spelled out apart from the engine's table: start restarts anything but a
+ * running phase, stop always stops, and a paused break is never resumed, only
+ * ended or extended. Anything not listed leaves the model as it is.
+ */
+static void model_action(struct fuzz_model *model, enum pomodoro_action action, int64_t now_ms) {
+    bool idle = model->state == POMODORO_STATE_IDLE;
+    bool running = is_running_state(model->state);
+    bool paused = model->state == POMODORO_STATE_PAUSED;
+
+    switch (action) {
+    case POMODORO_ACTION_START:
+        if (!running) {
+            model_start_work(model, 1, now_ms);
+        }
+        break;
+    case POMODORO_ACTION_STOP:
+        model_stop(model);
+        break;
+    case POMODORO_ACTION_PAUSE:
+        if (running) {
+            model_pause(model, now_ms);
+        } else if (paused && model->on_break) {
+            model_end_break(model, now_ms);
+        } else if (paused) {
+            model_resume_work(model, now_ms);
+        }
+        break;
+    case POMODORO_ACTION_SMART:
+        if (idle) {
+            model_start_work(model, 1, now_ms);
+        } else if (model->on_break) {
+            model_end_break(model, now_ms);
+        } else if (running) {
+            model_pause(model, now_ms);
+        } else {
+            model_resume_work(model, now_ms);
+        }
+        break;
+    case POMODORO_ACTION_RESUME:
+        if (model->on_break) {
+            model_end_break(model, now_ms);
+        } else if (paused) {
+            model_resume_work(model, now_ms);
+        }
+        break;
+    case POMODORO_ACTION_BREAK_EXTEND:
+        if (model->on_break) {
+            model_extend_break(model);
+        }
+        break;
+    case POMODORO_ACTION_BREAK_SKIP:
+        if (model->on_break) {
+            model_end_break(model, now_ms);
+        }
+        break;
+    }
+}
+
+/* Every phase end up to `now_ms`, chained back to back as the engine must. */
+static uint32_t model_advance(struct fuzz_model *model, int64_t now_ms) {
+    uint32_t transitions = 0;
+
+    while (is_running_state(model->state) && model->phase_end_ms <= now_ms) {
+        if (!model->on_break) {
+            model->phase_length_s = model->session >= POMODORO_MAX_SESSIONS
+                                        ? POMODORO_LONG_BREAK_SECONDS
+                                        : POMODORO_DEFAULT_BREAK_SECONDS;
+            model->state = POMODORO_STATE_BREAK;
+            model->on_break = true;
+            model->phase_end_ms += model->phase_length_s * 1000LL;
+        } else if (model->session >= POMODORO_MAX_SESSIONS) {
+            model_stop(model);
+        } else {
+            model_start_work(model, model->session + 1, model->phase_end_ms);
+        }
+        transitions++;
+    }
+
+    return transitions;
+}
+
+static bool model_matches(const struct fuzz_model *model, const struct pomodoro_status *status) {
+    if (model->state != status->state || model->on_break != status->on_break ||
+        model->session != status->session || model->phase_length_s != status->phase_total_seconds) {
+        return false;
+    }
+    if (is_running_state(model->state)) {
+        return model->phase_end_ms == status->phase_end_ms;
+    }
+    if (model->state == POMODORO_STATE_PAUSED) {
+        /* Whole seconds elapsed, as the engine shows them. */
+        uint32_t elapsed_s = (model->phase_length_s * 1000 - model->left_ms) / 1000;
+
+        return status->remaining_seconds == model->phase_length_s - elapsed_s;
+    }
+    return true;
+}
+
+static const char *check_status(const struct pomodoro_status *status, int64_t now_ms) {
+    if (status->remaining_seconds > status->phase_total_seconds) {
+        return "remaining past the phase length";
+    }
+    if (status->session > status->max_sessions) {
+        return "session past the maximum";
+    }
+    if ((status->state == POMODORO_STATE_IDLE) != (status->session == 0)) {
+        return "session out of step with the state";
+    }
+    if (is_running_state(status->state) && status->phase_end_ms <= now_ms) {
+        return "running phase past its end";
+    }
+    if (!is_running_state(status->state) && status->phase_end_ms != 0) {
+        return "phase end set while not running";
+    }
+    return NULL;
+}
+
+int pomodoro_fuzz_run(uint32_t steps, uint32_t seed, struct pomodoro_fuzz_result *result) {
+    uint32_t rng = seed ? seed : 1;
+
+    struct fuzz_model model;
+
+    *result = (struct pomodoro_fuzz_result){0};
+    pomodoro_stop();
+    model_stop(&model);
+
+    for (uint32_t step = 0; step < steps; step++) {
+        uint32_t roll = xorshift32(&rng);
+        struct pomodoro_status status;
+        const char *failure = NULL;
+
+        if (roll % 3 == 0) {
+            /* Mostly short hops around a deadline, sometimes several phases at once. */
+            uint32_t span = (roll & BIT(8)) ? 3000 : 2 * FUZZ_WORK_MS;
+            uint32_t ms = xorshift32(&rng) % span;
+
+            if (roll & BIT(9)) {
+                /* Slept through the deadlines: one late wakeup replays them all. */
+                pomodoro_clock_jump(ms);
+                pomodoro_clock_kick();
+            } else {
+                pomodoro_clock_advance(ms);
+            }
+            result->transitions += model_advance(&model, pomodoro_clock_now_ms());
+
+            status = pomodoro_current_status();
+            if (!model_matches(&model, &status)) {
+                failure = "timed transition lost or repeated";
+            }
+        } else {
+            enum pomodoro_action action = (roll >> 8) % FUZZ_ACTION_COUNT;
+
+            pomodoro_dispatch(action);
+            model_action(&model, action, pomodoro_clock_now_ms());
+
+            status = pomodoro_current_status();
+            if (!model_matches(&model, &status)) {
+                failure = "action transition wrong, lost or repeated";
+            }
+        }
+
+        if (!failure) {
+            failure = check_status(&status, pomodoro_clock_now_ms());
+        }
+
+        result->steps = step + 1;
+        if (failure) {
+            result->failure = failure;
+            result->status = status;
+            return -EIO;
+        }
+    }
+
+    return 0;
+}
+
+#if IS_ENABLED(CONFIG_SHELL)
+#include <zephyr/shell/shell.h>
+
+static int cmd_fuzz(const struct shell *sh, size_t argc, char **argv) {
+    uint32_t steps = strtoul(argv[1], NULL, 0);
+    uint32_t seed = argc > 2 ? strtoul(argv[2], NULL, 0) : 1;
+    struct pomodoro_fuzz_result result;
+    int64_t started = k_uptime_get();
+
+    int err = pomodoro_fuzz_run(steps, seed, &result);
+    if (err) {
+        shell_error(sh, "seed %u step %u: %s (state %u session %u remaining %u/%u s)", seed,
+                    result.steps - 1, result.failure, result.status.state, result.status.session,
+                    result.status.remaining_seconds, result.status.phase_total_seconds);
+        return err;
+    }
+
+    shell_print(sh, "seed %u: %u steps, %u timed transitions, %lld ms", seed, steps,
+                result.transitions, (long long)(k_uptime_get() - started));
+    return 0;
+}
+
+SHELL_SUBCMD_ADD((pomo), fuzz, NULL, "Random actions and time jumps on the virtual clock: <steps> [seed]",
+                 cmd_fuzz, 2, 1);
+#endif
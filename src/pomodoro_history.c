@@ -0,0 +1,297 @@
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/util.h>
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pomodoro_clock.h"
+#include "pomodoro_history.h"
+#include "pomodoro_workq.h"
+
+LOG_MODULE_DECLARE(pomodoro, CONFIG_ZMK_LOG_LEVEL);
+
+#define HISTORY_CAPACITY CONFIG_ZMK_POMODORO_HISTORY_RECORDS
+#define HISTORY_DAY_MS (24LL * 60 * 60 * 1000)
+#define HISTORY_ENDED_EARLY (POMODORO_HISTORY_FLAG_SKIPPED | POMODORO_HISTORY_FLAG_STOPPED)
+
+static struct k_spinlock history_lock;
+static struct pomodoro_history_record ring[HISTORY_CAPACITY];
+/* Records appended since history began; the newest one is at (total - 1) % capacity. */
+static uint32_t total;
+static uint32_t count;
+/* Day of uptime 0, so restored days keep counting up. */
+static uint16_t day_base;
+static struct pomodoro_history_day today;
+
+static uint16_t current_day(void) {
+    int64_t day = day_base + pomodoro_clock_now_ms() / HISTORY_DAY_MS;
+    return MIN(day, UINT16_MAX);
+}
+
+static void day_add(struct pomodoro_history_day *day, const struct pomodoro_history_record *record) {
+    bool ended_early = record->flags & HISTORY_ENDED_EARLY;
+
+    if (record->flags & POMODORO_HISTORY_FLAG_BREAK) {
+        day->break_s += record->duration_s;
+        if (ended_early) {
+            day->breaks_skipped++;
+        } else {
+            day->breaks_taken++;
+        }
+    } else {
+        day->focus_s += record->duration_s;
+        if (ended_early) {
+            day->work_stopped++;
+        } else {
+            day->work_completed++;
+        }
+    }
+
+    day->pauses += record->pauses;
+    day->extends += record->extends;
+}
+
+#if IS_ENABLED(CONFIG_ZMK_POMODORO_PERSIST)
+#include <zephyr/settings/settings.h>
+
+#define HISTORY_BATCH CONFIG_ZMK_POMODORO_HISTORY_FLUSH_RECORDS
+#define HISTORY_SLOTS (HISTORY_CAPACITY / HISTORY_BATCH)
+
+BUILD_ASSERT(HISTORY_CAPACITY % HISTORY_BATCH == 0,
+             "history capacity must be a multiple of the flush batch");
+
+/*
+ * Flash keeps one settings entry per batch-sized slice of the ring, so a
+ * flush rewrites a single slice and never the whole ring. `first` is the
+ * absolute index of the slice's first record and puts slices back in order
+ * on load.
+ */
+struct pomodoro_history_batch {
+    uint32_t first;
+    struct pomodoro_history_record records[HISTORY_BATCH];
+} __packed;
+
+#define HISTORY_BATCH_HEADER offsetof(struct pomodoro_history_batch, records)
+
+/* Records below this absolute index are in flash; only the flush work moves it. */
+static uint32_t flushed;
+static bool loaded;
+static uint32_t load_oldest = UINT32_MAX;
+static uint32_t load_total;
+
+static void flush_work_handler(struct k_work *work) {
+    ARG_UNUSED(work);
+    struct pomodoro_history_batch batch;
+    char key[sizeof("pomodoro/history/") + 4];
+
+    for (;;) {
+        k_spinlock_key_t lock = k_spin_lock(&history_lock);
+        if (flushed == total) {
+            k_spin_unlock(&history_lock, lock);
+            return;
+        }
+
+        uint32_t first = ROUND_DOWN(flushed, HISTORY_BATCH);
+        uint32_t n = MIN(total - first, HISTORY_BATCH);
+
+        for (uint32_t i = 0; i < n; i++) {
+            batch.records[i] = ring[(first + i) % HISTORY_CAPACITY];
+        }
+        k_spin_unlock(&history_lock, lock);
+
+        batch.first = first;
+        snprintk(key, sizeof(key), "pomodoro/history/%u",
+                 (unsigned int)((first / HISTORY_BATCH) % HISTORY_SLOTS));
+
+        int err = settings_save_one(key, &batch, HISTORY_BATCH_HEADER + n * sizeof(batch.records[0]));
+        if (err) {
+            /* The records stay pending and go out with the next batch. */
+            LOG_ERR("Failed to save pomodoro history: %d", err);
+            return;
+        }
+
+        flushed = first + n;
+    }
+}
+
+K_WORK_DEFINE(flush_work, flush_work_handler);
+
+static void request_flush(uint32_t appended, uint8_t flags) {
+    if (appended % HISTORY_BATCH == 0 || (flags & POMODORO_HISTORY_FLAG_SESSION_END)) {
+        k_work_submit_to_queue(pomodoro_work_q(), &flush_work);
+    }
+}
+
+static int history_settings_set(const char *name, size_t len, settings_read_cb read_cb,
+                                void *cb_arg) {
+    struct pomodoro_history_batch batch;
+    char *end;
+    unsigned long slot = strtoul(name, &end, 10);
+
+    /* Loaded once, before the engine records anything. */
+    if (loaded || total) {
+        return 0;
+    }
+
+    if (end == name || *end || slot >= HISTORY_SLOTS || len <= HISTORY_BATCH_HEADER ||
+        len > sizeof(batch) || (len - HISTORY_BATCH_HEADER) % sizeof(batch.records[0])) {
+        LOG_WRN("Ignoring pomodoro history entry %s of %zu bytes", name, len);
+        return -EINVAL;
+    }
+
+    int rc = read_cb(cb_arg, &batch, len);
+    if (rc < 0) {
+        return rc;
+    }
+
+    uint32_t n = (len - HISTORY_BATCH_HEADER) / sizeof(batch.records[0]);
+    if (batch.first % HISTORY_BATCH || (batch.first / HISTORY_BATCH) % HISTORY_SLOTS != slot) {
+        LOG_WRN("Ignoring misplaced pomodoro history slice %s", name);
+        return -EINVAL;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&history_lock);
+    for (uint32_t i = 0; i < n; i++) {
+        ring[(batch.first + i) % HISTORY_CAPACITY] = batch.records[i];
+    }
+    load_oldest = MIN(load_oldest, batch.first);
+    load_total = MAX(load_total, batch.first + n);
+    k_spin_unlock(&history_lock, key);
+    return 0;
+}
+
+/* Orders the loaded slices and rebuilds today's totals; the only full walk of the ring. */
+static int history_settings_commit(void) {
+    if (loaded || total) {
+        return 0;
+    }
+    loaded = true;
+
+    if (!load_total) {
+        return 0;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&history_lock);
+    total = load_total;
+    flushed = load_total;
+    count = MIN(load_total - load_oldest, HISTORY_CAPACITY);
+    day_base = ring[(total - 1) % HISTORY_CAPACITY].day;
+    today = (struct pomodoro_history_day){.day = day_base};
+
+    for (uint32_t age = 0; age < count; age++) {
+        const struct pomodoro_history_record *record = &ring[(total - 1 - age) % HISTORY_CAPACITY];
+        if (record->day != day_base) {
+            break;
+        }
+        day_add(&today, record);
+    }
+    k_spin_unlock(&history_lock, key);
+
+    LOG_INF("Restored %u pomodoro history records", count);
+    return 0;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(pomodoro_history, "pomodoro/history", NULL, history_settings_set,
+                               history_settings_commit, NULL);
+#else
+static inline void request_flush(uint32_t appended, uint8_t flags) {
+    ARG_UNUSED(appended);
+    ARG_UNUSED(flags);
+}
+#endif
+
+void pomodoro_history_append(const struct pomodoro_history_record *record) {
+    uint16_t day = current_day();
+
+    k_spinlock_key_t key = k_spin_lock(&history_lock);
+    struct pomodoro_history_record *slot = &ring[total % HISTORY_CAPACITY];
+
+    *slot = *record;
+    slot->day = day;
+    total++;
+    count = MIN(count + 1, HISTORY_CAPACITY);
+
+    if (today.day != day) {
+        today = (struct pomodoro_history_day){.day = day};
+    }
+    day_add(&today, slot);
+
+    uint32_t appended = total;
+    k_spin_unlock(&history_lock, key);
+
+    request_flush(appended, record->flags);
+}
+
+void pomodoro_history_today(struct pomodoro_history_day *day) {
+    uint16_t now = current_day();
+
+    k_spinlock_key_t key = k_spin_lock(&history_lock);
+    *day = today;
+    k_spin_unlock(&history_lock, key);
+
+    /* Nothing finished yet since the day rolled over. */
+    if (day->day != now) {
+        *day = (struct pomodoro_history_day){.day = now};
+    }
+}
+
+uint32_t pomodoro_history_count(void) {
+    k_spinlock_key_t key = k_spin_lock(&history_lock);
+    uint32_t held = count;
+    k_spin_unlock(&history_lock, key);
+    return held;
+}
+
+bool pomodoro_history_get(uint32_t age, struct pomodoro_history_record *record) {
+    k_spinlock_key_t key = k_spin_lock(&history_lock);
+    bool found = age < count;
+
+    if (found) {
+        *record = ring[(total - 1 - age) % HISTORY_CAPACITY];
+    }
+    k_spin_unlock(&history_lock, key);
+    return found;
+}
+
+#if IS_ENABLED(CONFIG_SHELL)
+#include <zephyr/shell/shell.h>
+
+static const char *record_kind(const struct pomodoro_history_record *record) {
+    if (record->flags & POMODORO_HISTORY_FLAG_LONG_BREAK) {
+        return "long break";
+    }
+    return record->flags & POMODORO_HISTORY_FLAG_BREAK ? "break" : "work";
+}
+
+static const char *record_outcome(const struct pomodoro_history_record *record) {
+    if (record->flags & POMODORO_HISTORY_FLAG_STOPPED) {
+        return "stopped";
+    }
+    return record->flags & POMODORO_HISTORY_FLAG_SKIPPED ? "skipped" : "done";
+}
+
+static int cmd_history(const struct shell *sh, size_t argc, char **argv) {
+    struct pomodoro_history_day day;
+    struct pomodoro_history_record record;
+    uint32_t shown = argc > 1 ? strtoul(argv[1], NULL, 10) : 8;
+
+    pomodoro_history_today(&day);
+    shell_print(sh, "day %u: focus %u min (%u done, %u stopped), breaks %u min (%u taken, %u skipped)",
+                day.day, day.focus_s / 60, day.work_completed, day.work_stopped, day.break_s / 60,
+                day.breaks_taken, day.breaks_skipped);
+    shell_print(sh, "  pauses %u, extends %u, %u records held", day.pauses, day.extends,
+                pomodoro_history_count());
+
+    for (uint32_t age = 0; age < shown && pomodoro_history_get(age, &record); age++) {
+        shell_print(sh, "  day %u sess %u %-10s %-7s %5u s, %u pauses, %u extends", record.day,
+                    record.session, record_kind(&record), record_outcome(&record),
+                    record.duration_s, record.pauses, record.extends);
+    }
+    return 0;
+}
+
+SHELL_SUBCMD_ADD((pomo), history, NULL, "Today's totals and the last N phases (default 8)",
+                 cmd_history, 1, 1);
+#endif
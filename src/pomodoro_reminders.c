@@ -0,0 +1,87 @@
+#include <zephyr/kernel.h>
+#include <zephyr/init.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
+
+#include <zmk/event_manager.h>
+#include <zmk/events/pomodoro_reminder_changed.h>
+
+#include "pomodoro_clock.h"
+#include "pomodoro_reminders.h"
+#include "pomodoro_timer.h"
+#include "pomodoro_trace.h"
+
+LOG_MODULE_DECLARE(pomodoro, CONFIG_ZMK_LOG_LEVEL);
+
+#define REMINDER_SHOW_MS (CONFIG_ZMK_POMODORO_REMINDER_SHOW_SECONDS * 1000)
+
+/*
+ * Each reminder is one timer that alternates between two deadlines: the
+ * next time it comes due, and the end of the window it is shown for.
+ */
+struct pomodoro_reminder {
+    struct pomodoro_timer timer;
+    uint32_t interval_ms;
+    int64_t due_at_ms;
+    bool due;
+};
+
+static atomic_t due_mask = ATOMIC_INIT(0);
+
+static void reminder_expired(struct pomodoro_timer *timer);
+
+static struct pomodoro_reminder reminders[POMODORO_REMINDER_COUNT] = {
+    [POMODORO_REMINDER_STANDUP] = {
+        .timer = POMODORO_TIMER_INITIALIZER(reminder_expired),
+        .interval_ms = CONFIG_ZMK_POMODORO_REMINDER_STANDUP_MINUTES * 60 * 1000,
+    },
+    [POMODORO_REMINDER_HYDRATION] = {
+        .timer = POMODORO_TIMER_INITIALIZER(reminder_expired),
+        .interval_ms = CONFIG_ZMK_POMODORO_REMINDER_HYDRATION_MINUTES * 60 * 1000,
+    },
+};
+
+static void reminder_expired(struct pomodoro_timer *timer) {
+    struct pomodoro_reminder *reminder = CONTAINER_OF(timer, struct pomodoro_reminder, timer);
+    int id = reminder - reminders;
+
+    if (!reminder->due) {
+        /*
+         * Counted from when it actually came due, so a wakeup replayed after
+         * sleep shows once instead of catching up on every missed interval.
+         */
+        reminder->due = true;
+        reminder->due_at_ms = pomodoro_clock_now_ms();
+        atomic_set_bit(&due_mask, id);
+        pomodoro_timer_start(timer, reminder->due_at_ms + REMINDER_SHOW_MS);
+    } else {
+        reminder->due = false;
+        atomic_clear_bit(&due_mask, id);
+        pomodoro_timer_start(timer, reminder->due_at_ms + reminder->interval_ms);
+    }
+
+    pomodoro_trace(POMODORO_TRACE_REMINDER, atomic_get(&due_mask));
+    raise_zmk_pomodoro_reminder_changed(
+        (struct zmk_pomodoro_reminder_changed){.due = atomic_get(&due_mask)});
+}
+
+uint32_t pomodoro_reminders_due(void) { return atomic_get(&due_mask); }
+
+static int pomodoro_reminders_init(void) {
+    int64_t now = pomodoro_clock_now_ms();
+
+    for (int i = 0; i < POMODORO_REMINDER_COUNT; i++) {
+        if (reminders[i].interval_ms == 0) {
+            continue;
+        }
+
+        int err = pomodoro_timer_start(&reminders[i].timer, now + reminders[i].interval_ms);
+        if (err) {
+            LOG_ERR("No timer slot for pomodoro reminder %d: %d", i, err);
+        }
+    }
+    return 0;
+}
+
+SYS_INIT(pomodoro_reminders_init, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
@@ -0,0 +1,107 @@
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/sys/util.h>
+
+#include <string.h>
+
+#include "pomodoro_settings.h"
+#include "pomodoro_workq.h"
+
+LOG_MODULE_DECLARE(pomodoro, CONFIG_ZMK_LOG_LEVEL);
+
+#define POMODORO_SETTINGS_KEY "pomodoro/state"
+
+static struct k_spinlock pending_lock;
+static struct pomodoro_saved_state pending;
+static struct pomodoro_saved_state stored;
+static bool has_stored;
+static bool has_restored;
+static atomic_t write_count = ATOMIC_INIT(0);
+
+static int pomodoro_settings_set(const char *name, size_t len, settings_read_cb read_cb,
+                                 void *cb_arg) {
+    const char *next;
+
+    if (!settings_name_steq(name, "state", &next) || next) {
+        return -ENOENT;
+    }
+
+    if (len != sizeof(stored)) {
+        LOG_WRN("Ignoring pomodoro state of unexpected size %zu", len);
+        return -EINVAL;
+    }
+
+    int rc = read_cb(cb_arg, &stored, sizeof(stored));
+    if (rc < 0) {
+        return rc;
+    }
+
+    has_stored = stored.version == POMODORO_SETTINGS_VERSION;
+    has_restored = has_stored;
+    return 0;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(pomodoro, "pomodoro", NULL, pomodoro_settings_set, NULL, NULL);
+
+static void save_work_handler(struct k_work *work) {
+    ARG_UNUSED(work);
+    struct pomodoro_saved_state state;
+
+    k_spinlock_key_t key = k_spin_lock(&pending_lock);
+    state = pending;
+    k_spin_unlock(&pending_lock, key);
+
+    if (has_stored && memcmp(&state, &stored, sizeof(state)) == 0) {
+        return;
+    }
+
+    int err = settings_save_one(POMODORO_SETTINGS_KEY, &state, sizeof(state));
+    if (err) {
+        LOG_ERR("Failed to save pomodoro state: %d", err);
+        return;
+    }
+
+    stored = state;
+    has_stored = true;
+    atomic_inc(&write_count);
+    LOG_DBG("pomodoro state saved, %ld writes this session", atomic_get(&write_count));
+}
+
+K_WORK_DELAYABLE_DEFINE(save_work, save_work_handler);
+
+void pomodoro_settings_request_save(const struct pomodoro_saved_state *state) {
+    k_spinlock_key_t key = k_spin_lock(&pending_lock);
+    pending = *state;
+    pending.version = POMODORO_SETTINGS_VERSION;
+    k_spin_unlock(&pending_lock, key);
+
+    /* Not rescheduled: a burst of transitions commits once, at the first deadline. */
+    k_work_schedule_for_queue(pomodoro_work_q(), &save_work,
+                              K_MSEC(CONFIG_ZMK_SETTINGS_SAVE_DEBOUNCE));
+}
+
+int pomodoro_settings_restore(struct pomodoro_saved_state *state) {
+    int err = settings_subsys_init();
+    if (err) {
+        return err;
+    }
+
+    /* Only what this load reads counts, not a state cached by an earlier one. */
+    has_restored = false;
+    err = settings_load_subtree("pomodoro");
+    if (err) {
+        return err;
+    }
+
+    if (!has_restored) {
+        return -ENOENT;
+    }
+
+    *state = stored;
+    return 0;
+}
+
+uint32_t pomodoro_settings_write_count(void) { return atomic_get(&write_count); }
+
+void pomodoro_settings_reset_write_count(void) { atomic_set(&write_count, 0); }
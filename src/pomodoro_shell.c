@@ -0,0 +1,6 @@
+#include <zephyr/shell/shell.h>
+
+/* Root of the `pomo` command; each module adds its own subcommands with SHELL_SUBCMD_ADD. */
+SHELL_SUBCMD_SET_CREATE(pomodoro_shell_cmds, (pomo));
+
+SHELL_CMD_REGISTER(pomo, &pomodoro_shell_cmds, "Pomodoro module", NULL);
@@ -0,0 +1,219 @@
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include "pomodoro_clock.h"
+#include "pomodoro_settings.h"
+#include "pomodoro_stats.h"
+#include "pomodoro_sync.h"
+
+LOG_MODULE_DECLARE(pomodoro, CONFIG_ZMK_LOG_LEVEL);
+
+struct pomodoro_stat_span {
+    uint32_t count;
+    uint32_t max;
+    uint64_t total;
+};
+
+static atomic_t counters[POMODORO_STAT_COUNTER_COUNT];
+
+static struct k_spinlock span_lock;
+static struct pomodoro_stat_span spans[POMODORO_STAT_TIMING_COUNT];
+
+/* Also the JSON keys, so keep them identifier-like. */
+static const char *const counter_names[POMODORO_STAT_COUNTER_COUNT] = {
+    [POMODORO_STAT_TICK_WAKEUPS] = "tick_wakeups",
+    [POMODORO_STAT_DISPLAY_SUBMITS] = "display_submits",
+    [POMODORO_STAT_DISPLAY_REDRAWS] = "display_redraws",
+    [POMODORO_STAT_DISPLAY_SKIPPED] = "display_skipped",
+    [POMODORO_STAT_INVALIDATED_ROWS] = "invalidated_rows",
+    [POMODORO_STAT_PHASES] = "phases",
+    [POMODORO_STAT_RENDER_PIXELS] = "render_px",
+    [POMODORO_STAT_FLUSHED_ROWS] = "flushed_rows",
+};
+
+static const char *const span_names[POMODORO_STAT_TIMING_COUNT] = {
+    [POMODORO_STAT_LOCK_WAIT] = "lock_wait",
+    [POMODORO_STAT_LOCK_HOLD] = "lock_hold",
+    [POMODORO_STAT_DRAW_LATENCY] = "draw_latency",
+    [POMODORO_STAT_KEY_HANDLER] = "key_handler",
+    [POMODORO_STAT_TICK] = "tick",
+    [POMODORO_STAT_REDRAW] = "redraw",
+    [POMODORO_STAT_WAKE_LATENCY] = "wake_latency",
+    [POMODORO_STAT_RENDER] = "render",
+};
+
+/*
+ * Start of the current measurement window, for the per-hour rates. On the
+ * Pomodoro clock, so a virtual-clock run gets rates in its own time.
+ */
+static int64_t window_start_ms;
+
+void pomodoro_stats_add(enum pomodoro_stat_counter counter, uint32_t value) {
+    atomic_add(&counters[counter], value);
+}
+
+void pomodoro_stats_record(enum pomodoro_stat_timing timing, uint32_t cycles) {
+    k_spinlock_key_t key = k_spin_lock(&span_lock);
+    struct pomodoro_stat_span *span = &spans[timing];
+
+    span->count++;
+    span->total += cycles;
+    span->max = MAX(span->max, cycles);
+    k_spin_unlock(&span_lock, key);
+}
+
+void pomodoro_stats_reset(void) {
+    for (int i = 0; i < POMODORO_STAT_COUNTER_COUNT; i++) {
+        atomic_set(&counters[i], 0);
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&span_lock);
+    memset(spans, 0, sizeof(spans));
+    window_start_ms = pomodoro_clock_now_ms();
+    k_spin_unlock(&span_lock, key);
+}
+
+uint32_t pomodoro_stats_get(enum pomodoro_stat_counter counter) {
+    return atomic_get(&counters[counter]);
+}
+
+struct pomodoro_stats_snapshot {
+    int64_t window_ms;
+    uint32_t counters[POMODORO_STAT_COUNTER_COUNT];
+    struct pomodoro_stat_span spans[POMODORO_STAT_TIMING_COUNT];
+};
+
+static void take_snapshot(struct pomodoro_stats_snapshot *snap) {
+    for (int i = 0; i < POMODORO_STAT_COUNTER_COUNT; i++) {
+        snap->counters[i] = atomic_get(&counters[i]);
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&span_lock);
+    memcpy(snap->spans, spans, sizeof(snap->spans));
+    snap->window_ms = pomodoro_clock_now_ms() - window_start_ms;
+    k_spin_unlock(&span_lock, key);
+}
+
+static uint32_t span_mean_us(const struct pomodoro_stat_span *span) {
+    return span->count ? k_cyc_to_us_floor32((uint32_t)(span->total / span->count)) : 0;
+}
+
+/* Rate per hour of window, rounded down; 0 until some time has passed. */
+static uint32_t per_hour(uint32_t count, int64_t window_ms) {
+    return window_ms > 0 ? (uint32_t)(((uint64_t)count * 3600000) / window_ms) : 0;
+}
+
+typedef void (*pomodoro_stats_line_t)(void *arg, const char *line);
+
+/* Formats one line per counter, shared by the log dump and the shell. */
+static void format_stats(pomodoro_stats_line_t emit, void *arg) {
+    struct pomodoro_stats_snapshot snap;
+    char line[64];
+
+    take_snapshot(&snap);
+
+    snprintf(line, sizeof(line), "%-16s %lld ms", "window", (long long)snap.window_ms);
+    emit(arg, line);
+
+    for (int i = 0; i < POMODORO_STAT_COUNTER_COUNT; i++) {
+        snprintf(line, sizeof(line), "%-16s %u", counter_names[i], snap.counters[i]);
+        emit(arg, line);
+    }
+
+    snprintf(line, sizeof(line), "%-16s %u", "wakeups_per_h",
+             per_hour(snap.counters[POMODORO_STAT_TICK_WAKEUPS], snap.window_ms));
+    emit(arg, line);
+
+    for (int i = 0; i < POMODORO_STAT_TIMING_COUNT; i++) {
+        const struct pomodoro_stat_span *span = &snap.spans[i];
+
+        snprintf(line, sizeof(line), "%-16s n=%u mean=%uus max=%uus", span_names[i], span->count,
+                 span_mean_us(span), k_cyc_to_us_floor32(span->max));
+        emit(arg, line);
+    }
+
+    snprintf(line, sizeof(line), "%-16s %u", "settings_writes", pomodoro_settings_write_count());
+    emit(arg, line);
+    snprintf(line, sizeof(line), "%-16s %u", "sync_bytes", pomodoro_sync_bytes_sent());
+    emit(arg, line);
+    snprintf(line, sizeof(line), "%-16s last=%ums max=%ums", "sync_latency",
+             pomodoro_sync_last_latency_ms(), pomodoro_sync_max_latency_ms());
+    emit(arg, line);
+}
+
+/*
+ * One JSON object per call, for host-side collection of runs (for example
+ * native_sim with accelerated time).
+ */
+int pomodoro_stats_json(char *buf, size_t len) {
+    struct pomodoro_stats_snapshot snap;
+    size_t n = 0;
+
+    take_snapshot(&snap);
+
+#define JSON_APPEND(...)                                                                           \
+    n += snprintf(buf + MIN(n, len), len - MIN(n, len), __VA_ARGS__)
+
+    JSON_APPEND("{\"window_ms\":%lld", (long long)snap.window_ms);
+    for (int i = 0; i < POMODORO_STAT_COUNTER_COUNT; i++) {
+        JSON_APPEND(",\"%s\":%u", counter_names[i], snap.counters[i]);
+    }
+    JSON_APPEND(",\"wakeups_per_h\":%u",
+                per_hour(snap.counters[POMODORO_STAT_TICK_WAKEUPS], snap.window_ms));
+    for (int i = 0; i < POMODORO_STAT_TIMING_COUNT; i++) {
+        JSON_APPEND(",\"%s\":{\"n\":%u,\"mean_us\":%u,\"max_us\":%u}", span_names[i],
+                    snap.spans[i].count, span_mean_us(&snap.spans[i]),
+                    k_cyc_to_us_floor32(snap.spans[i].max));
+    }
+    JSON_APPEND(",\"settings_writes\":%u,\"sync_bytes\":%u,\"sync_latency_max_ms\":%u}",
+                pomodoro_settings_write_count(), pomodoro_sync_bytes_sent(),
+                pomodoro_sync_max_latency_ms());
+
+#undef JSON_APPEND
+
+    return n < len ? (int)n : -ENOSPC;
+}
+
+static void log_line(void *arg, const char *line) {
+    ARG_UNUSED(arg);
+    LOG_INF("pomodoro stats: %s", line);
+}
+
+void pomodoro_stats_log(void) { format_stats(log_line, NULL); }
+
+#if IS_ENABLED(CONFIG_SHELL)
+#include <zephyr/shell/shell.h>
+
+static void shell_line(void *arg, const char *line) {
+    shell_print((const struct shell *)arg, "%s", line);
+}
+
+static int cmd_stats(const struct shell *sh, size_t argc, char **argv) {
+    if (argc > 1 && strcmp(argv[1], "reset") == 0) {
+        pomodoro_stats_reset();
+        shell_print(sh, "pomodoro stats reset");
+        return 0;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "json") == 0) {
+        char buf[1024];
+
+        if (pomodoro_stats_json(buf, sizeof(buf)) < 0) {
+            shell_error(sh, "pomodoro stats JSON truncated");
+            return -ENOSPC;
+        }
+        shell_print(sh, "%s", buf);
+        return 0;
+    }
+
+    format_stats(shell_line, (void *)sh);
+    return 0;
+}
+
+SHELL_SUBCMD_ADD((pomo), stats, NULL, "Show counters; 'json' or 'reset'", cmd_stats, 1, 1);
+#endif
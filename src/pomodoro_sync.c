@@ -0,0 +1,253 @@
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/util.h>
+
+#include <string.h>
+
+#include <zmk/event_manager.h>
+#include <zmk/events/pomodoro_state_changed.h>
+
+#include "pomodoro.h"
+#include "pomodoro_clock.h"
+#include "pomodoro_sync.h"
+#include "pomodoro_workq.h"
+
+LOG_MODULE_DECLARE(pomodoro, CONFIG_ZMK_LOG_LEVEL);
+
+/* Sender side. Events can be raised from several threads at once, so serialize here. */
+K_MUTEX_DEFINE(send_lock);
+static struct pomodoro_sync_packet last_sent;
+static uint32_t last_sent_generation;
+static int64_t last_sent_phase_end_ms;
+static bool has_sent;
+static atomic_t bytes_sent = ATOMIC_INIT(0);
+
+/* Receiver side: last packet plus the local uptime its phase ends at. */
+static struct k_spinlock mirror_lock;
+static struct pomodoro_sync_packet mirror;
+static int64_t mirror_phase_end_ms;
+static bool has_mirror;
+static uint32_t mirror_generation;
+
+/* Press-to-mirror latency for behaviors forwarded from this side; 0 when none is pending. */
+static int64_t request_started_ms;
+static uint32_t last_latency_ms;
+static uint32_t max_latency_ms;
+
+static bool is_running_state(uint8_t state) {
+    return state == POMODORO_STATE_WORK || state == POMODORO_STATE_BREAK;
+}
+
+/*
+ * Nothing a receiver would show differently: the same fields and the same
+ * phase end, or while stopped or paused the same time left. Coalesced
+ * commits, such as a pause and resume, can move only the phase end.
+ */
+static bool same_delta(const struct pomodoro_sync_packet *a, int64_t a_phase_end_ms,
+                       const struct pomodoro_sync_packet *b, int64_t b_phase_end_ms) {
+    if (a_phase_end_ms != b_phase_end_ms ||
+        (!a_phase_end_ms && a->remaining_ms != b->remaining_ms)) {
+        return false;
+    }
+    return a->state == b->state && a->session == b->session &&
+           a->max_sessions == b->max_sessions && a->flags == b->flags &&
+           a->phase_total_s == b->phase_total_s;
+}
+
+static void encode_packet(const struct pomodoro_status *status, uint32_t remaining_ms,
+                          struct pomodoro_sync_packet *packet) {
+    *packet = (struct pomodoro_sync_packet){
+        .version = POMODORO_SYNC_VERSION,
+        .state = status->state,
+        .session = status->session,
+        .max_sessions = status->max_sessions,
+        .flags = (status->on_break ? POMODORO_SYNC_FLAG_ON_BREAK : 0) |
+                 (status->resume_on_any_key ? POMODORO_SYNC_FLAG_RESUME_ON_ANY_KEY : 0),
+        .generation = (uint16_t)status->generation,
+        .phase_total_s = MIN(status->phase_total_seconds, UINT16_MAX),
+        .remaining_ms = remaining_ms,
+    };
+}
+
+static void sync_publish(const struct pomodoro_status *status, uint32_t remaining_ms) {
+    struct pomodoro_sync_packet packet;
+
+    encode_packet(status, remaining_ms, &packet);
+    k_mutex_lock(&send_lock, K_FOREVER);
+
+    /* A commit that lost the race to a newer one must not overwrite it. */
+    if (has_sent && ((int32_t)(status->generation - last_sent_generation) < 0 ||
+                     same_delta(&packet, status->phase_end_ms, &last_sent,
+                                last_sent_phase_end_ms))) {
+        k_mutex_unlock(&send_lock);
+        return;
+    }
+
+    if (has_sent && last_sent.state == POMODORO_STATE_IDLE &&
+        packet.state != POMODORO_STATE_IDLE) {
+        atomic_set(&bytes_sent, 0);
+    }
+
+    int err = pomodoro_sync_transport_send(&packet);
+    if (err) {
+        /* Keep last_sent so the next commit retries the delta. */
+        LOG_DBG("pomodoro sync send failed: %d", err);
+        k_mutex_unlock(&send_lock);
+        return;
+    }
+
+    last_sent = packet;
+    last_sent_generation = status->generation;
+    last_sent_phase_end_ms = status->phase_end_ms;
+    has_sent = true;
+    atomic_add(&bytes_sent, sizeof(packet));
+    k_mutex_unlock(&send_lock);
+
+    if (packet.state == POMODORO_STATE_IDLE) {
+        LOG_INF("pomodoro sync: %ld bytes sent this session", atomic_get(&bytes_sent));
+    }
+}
+
+void pomodoro_sync_current_packet(struct pomodoro_sync_packet *packet) {
+    struct pomodoro_status status = pomodoro_current_status();
+
+    encode_packet(&status, status.remaining_seconds * 1000, packet);
+}
+
+uint32_t pomodoro_sync_bytes_sent(void) { return atomic_get(&bytes_sent); }
+
+#if !IS_ENABLED(CONFIG_ZMK_SPLIT_ROLE_CENTRAL)
+static int pomodoro_sync_state_listener(const zmk_event_t *eh) {
+    const struct zmk_pomodoro_state_changed *ev = as_zmk_pomodoro_state_changed(eh);
+    if (ev == NULL) {
+        return ZMK_EV_EVENT_BUBBLE;
+    }
+
+    /* In ms while running, so the mirror does not drift by a rounding second. */
+    uint32_t remaining_ms = ev->status.remaining_seconds * 1000;
+    if (ev->status.phase_end_ms) {
+        int64_t left = ev->status.phase_end_ms - pomodoro_clock_now_ms();
+        remaining_ms = left > 0 ? (uint32_t)left : 0;
+    }
+
+    sync_publish(&ev->status, remaining_ms);
+    return ZMK_EV_EVENT_BUBBLE;
+}
+
+ZMK_LISTENER(pomodoro_sync, pomodoro_sync_state_listener);
+ZMK_SUBSCRIPTION(pomodoro_sync, zmk_pomodoro_state_changed);
+#endif
+
+/*
+ * Re-raises the mirror on the central, off the BT RX thread that received it.
+ * Packets that land before this runs are announced once, as the latest.
+ */
+static void mirror_raise_work_handler(struct k_work *work) {
+    ARG_UNUSED(work);
+
+    struct pomodoro_status status;
+
+    if (pomodoro_sync_mirror_status(&status)) {
+        raise_zmk_pomodoro_state_changed((struct zmk_pomodoro_state_changed){.status = status});
+    }
+}
+
+K_WORK_DEFINE(mirror_raise_work, mirror_raise_work_handler);
+
+void pomodoro_sync_receive(const struct pomodoro_sync_packet *packet) {
+    if (packet->version != POMODORO_SYNC_VERSION) {
+        LOG_WRN("Ignoring pomodoro sync packet v%u", packet->version);
+        return;
+    }
+
+    int64_t now = pomodoro_clock_now_ms();
+    int64_t started_ms;
+    uint32_t latency_ms = 0;
+
+    k_spinlock_key_t key = k_spin_lock(&mirror_lock);
+    mirror = *packet;
+    mirror_phase_end_ms = now + packet->remaining_ms;
+    has_mirror = true;
+    mirror_generation++;
+
+    started_ms = request_started_ms;
+    if (started_ms) {
+        latency_ms = now - started_ms;
+        last_latency_ms = latency_ms;
+        max_latency_ms = MAX(max_latency_ms, latency_ms);
+        request_started_ms = 0;
+    }
+    k_spin_unlock(&mirror_lock, key);
+
+    if (started_ms) {
+        LOG_DBG("pomodoro press-to-state latency %u ms", latency_ms);
+    }
+
+    if (IS_ENABLED(CONFIG_ZMK_SPLIT_ROLE_CENTRAL)) {
+        k_work_submit_to_queue(pomodoro_work_q(), &mirror_raise_work);
+    }
+}
+
+void pomodoro_sync_note_request(void) {
+    k_spinlock_key_t key = k_spin_lock(&mirror_lock);
+    /* Keep the oldest press if several land before the peripheral answers. */
+    if (!request_started_ms) {
+        request_started_ms = MAX(pomodoro_clock_now_ms(), 1);
+    }
+    k_spin_unlock(&mirror_lock, key);
+}
+
+uint32_t pomodoro_sync_last_latency_ms(void) {
+    k_spinlock_key_t key = k_spin_lock(&mirror_lock);
+    uint32_t latency = last_latency_ms;
+    k_spin_unlock(&mirror_lock, key);
+    return latency;
+}
+
+uint32_t pomodoro_sync_max_latency_ms(void) {
+    k_spinlock_key_t key = k_spin_lock(&mirror_lock);
+    uint32_t latency = max_latency_ms;
+    k_spin_unlock(&mirror_lock, key);
+    return latency;
+}
+
+bool pomodoro_sync_mirror_status(struct pomodoro_status *status) {
+    k_spinlock_key_t key = k_spin_lock(&mirror_lock);
+    struct pomodoro_sync_packet packet = mirror;
+    int64_t phase_end_ms = mirror_phase_end_ms;
+    bool valid = has_mirror;
+    uint32_t generation = mirror_generation;
+    k_spin_unlock(&mirror_lock, key);
+
+    if (!valid) {
+        return false;
+    }
+
+    uint32_t remaining_ms = packet.remaining_ms;
+    if (is_running_state(packet.state)) {
+        int64_t left = phase_end_ms - pomodoro_clock_now_ms();
+        remaining_ms = left > 0 ? left : 0;
+    }
+
+    *status = (struct pomodoro_status){
+        .state = packet.state,
+        .session = packet.session,
+        .max_sessions = packet.max_sessions,
+        .on_break = packet.flags & POMODORO_SYNC_FLAG_ON_BREAK,
+        .paused = packet.state == POMODORO_STATE_PAUSED,
+        .remaining_seconds = DIV_ROUND_UP(remaining_ms, 1000),
+        .phase_total_seconds = packet.phase_total_s,
+        .resume_on_any_key = packet.flags & POMODORO_SYNC_FLAG_RESUME_ON_ANY_KEY,
+        .show_seconds = true,
+        .generation = generation,
+        .phase_end_ms = is_running_state(packet.state) ? phase_end_ms : 0,
+    };
+    return true;
+}
+
+uint32_t pomodoro_sync_mirror_generation(void) {
+    k_spinlock_key_t key = k_spin_lock(&mirror_lock);
+    uint32_t generation = mirror_generation;
+    k_spin_unlock(&mirror_lock, key);
+    return generation;
+}
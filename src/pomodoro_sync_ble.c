@@ -0,0 +1,195 @@
+#include <zephyr/kernel.h>
+#include <zephyr/bluetooth/bluetooth.h>
+#include <zephyr/bluetooth/conn.h>
+#include <zephyr/bluetooth/gatt.h>
+#include <zephyr/bluetooth/uuid.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/util.h>
+
+#include <string.h>
+
+#include "pomodoro_sync.h"
+
+LOG_MODULE_DECLARE(pomodoro, CONFIG_ZMK_LOG_LEVEL);
+
+#define POMODORO_SYNC_SERVICE_UUID_VAL                                                             \
+    BT_UUID_128_ENCODE(0x9f4a1c20, 0x5e1b, 0x4c7d, 0x8a3e, 0x6b2f0d915c01)
+#define POMODORO_SYNC_STATE_UUID_VAL                                                               \
+    BT_UUID_128_ENCODE(0x9f4a1c20, 0x5e1b, 0x4c7d, 0x8a3e, 0x6b2f0d915c02)
+
+static struct bt_uuid_128 sync_service_uuid = BT_UUID_INIT_128(POMODORO_SYNC_SERVICE_UUID_VAL);
+static struct bt_uuid_128 sync_state_uuid = BT_UUID_INIT_128(POMODORO_SYNC_STATE_UUID_VAL);
+
+#if !IS_ENABLED(CONFIG_ZMK_SPLIT_ROLE_CENTRAL)
+
+static ssize_t read_state(struct bt_conn *conn, const struct bt_gatt_attr *attr, void *buf,
+                          uint16_t len, uint16_t offset) {
+    struct pomodoro_sync_packet packet;
+
+    pomodoro_sync_current_packet(&packet);
+    return bt_gatt_attr_read(conn, attr, buf, len, offset, &packet, sizeof(packet));
+}
+
+static void state_ccc_changed(const struct bt_gatt_attr *attr, uint16_t value) {
+    ARG_UNUSED(attr);
+    LOG_DBG("pomodoro sync notifications %s", value == BT_GATT_CCC_NOTIFY ? "on" : "off");
+}
+
+BT_GATT_SERVICE_DEFINE(pomodoro_sync_svc, BT_GATT_PRIMARY_SERVICE(&sync_service_uuid),
+                       BT_GATT_CHARACTERISTIC(&sync_state_uuid.uuid,
+                                              BT_GATT_CHRC_READ | BT_GATT_CHRC_NOTIFY,
+                                              BT_GATT_PERM_READ_ENCRYPT, read_state, NULL, NULL),
+                       BT_GATT_CCC(state_ccc_changed,
+                                   BT_GATT_PERM_READ_ENCRYPT | BT_GATT_PERM_WRITE_ENCRYPT));
+
+int pomodoro_sync_transport_send(const struct pomodoro_sync_packet *packet) {
+    /* Returns -ENOTCONN until the central has subscribed; the caller retries on the next commit. */
+    return bt_gatt_notify(NULL, &pomodoro_sync_svc.attrs[1], packet, sizeof(*packet));
+}
+
+#else
+
+static struct bt_gatt_discover_params discover_params;
+static struct bt_gatt_subscribe_params subscribe_params;
+static struct bt_gatt_read_params read_params;
+static struct bt_conn *peripheral_conn;
+
+static void receive_raw(const void *data, uint16_t length) {
+    struct pomodoro_sync_packet packet;
+
+    if (length != sizeof(packet)) {
+        LOG_WRN("Ignoring pomodoro sync packet of %u bytes", length);
+        return;
+    }
+
+    memcpy(&packet, data, sizeof(packet));
+    pomodoro_sync_receive(&packet);
+}
+
+static uint8_t notify_cb(struct bt_conn *conn, struct bt_gatt_subscribe_params *params,
+                         const void *data, uint16_t length) {
+    ARG_UNUSED(conn);
+
+    if (!data) {
+        params->value_handle = 0;
+        return BT_GATT_ITER_STOP;
+    }
+
+    receive_raw(data, length);
+    return BT_GATT_ITER_CONTINUE;
+}
+
+static uint8_t read_cb(struct bt_conn *conn, uint8_t err, struct bt_gatt_read_params *params,
+                       const void *data, uint16_t length) {
+    ARG_UNUSED(conn);
+    ARG_UNUSED(params);
+
+    if (err) {
+        LOG_WRN("pomodoro sync initial read failed: %u", err);
+    } else if (data) {
+        receive_raw(data, length);
+    }
+    return BT_GATT_ITER_STOP;
+}
+
+static uint8_t discover_cb(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+                           struct bt_gatt_discover_params *params) {
+    if (!attr) {
+        LOG_DBG("pomodoro sync service not found on peripheral");
+        return BT_GATT_ITER_STOP;
+    }
+
+    switch (params->type) {
+    case BT_GATT_DISCOVER_PRIMARY:
+        discover_params.uuid = &sync_state_uuid.uuid;
+        discover_params.start_handle = attr->handle + 1;
+        discover_params.type = BT_GATT_DISCOVER_CHARACTERISTIC;
+        break;
+
+    case BT_GATT_DISCOVER_CHARACTERISTIC:
+        subscribe_params.value_handle = bt_gatt_attr_value_handle(attr);
+        discover_params.uuid = BT_UUID_GATT_CCC;
+        discover_params.start_handle = attr->handle + 2;
+        discover_params.type = BT_GATT_DISCOVER_DESCRIPTOR;
+        break;
+
+    case BT_GATT_DISCOVER_DESCRIPTOR: {
+        subscribe_params.ccc_handle = attr->handle;
+        subscribe_params.notify = notify_cb;
+        subscribe_params.value = BT_GATT_CCC_NOTIFY;
+
+        int err = bt_gatt_subscribe(conn, &subscribe_params);
+        if (err && err != -EALREADY) {
+            LOG_ERR("pomodoro sync subscribe failed: %d", err);
+            return BT_GATT_ITER_STOP;
+        }
+
+        /* Notifications only carry transitions, so fetch the state as it stands now. */
+        read_params.func = read_cb;
+        read_params.handle_count = 1;
+        read_params.single.handle = subscribe_params.value_handle;
+        read_params.single.offset = 0;
+        bt_gatt_read(conn, &read_params);
+        return BT_GATT_ITER_STOP;
+    }
+
+    default:
+        return BT_GATT_ITER_STOP;
+    }
+
+    int err = bt_gatt_discover(conn, &discover_params);
+    if (err) {
+        LOG_ERR("pomodoro sync discovery failed: %d", err);
+    }
+    return BT_GATT_ITER_STOP;
+}
+
+static void security_changed(struct bt_conn *conn, bt_security_t level,
+                             enum bt_security_err err) {
+    struct bt_conn_info info;
+
+    if (err || level < BT_SECURITY_L2 || peripheral_conn) {
+        return;
+    }
+
+    /* Only the split link, where this side is the central, carries the service. */
+    if (bt_conn_get_info(conn, &info) || info.role != BT_CONN_ROLE_CENTRAL) {
+        return;
+    }
+
+    peripheral_conn = bt_conn_ref(conn);
+    discover_params.uuid = &sync_service_uuid.uuid;
+    discover_params.func = discover_cb;
+    discover_params.start_handle = BT_ATT_FIRST_ATTRIBUTE_HANDLE;
+    discover_params.end_handle = BT_ATT_LAST_ATTRIBUTE_HANDLE;
+    discover_params.type = BT_GATT_DISCOVER_PRIMARY;
+
+    int rc = bt_gatt_discover(conn, &discover_params);
+    if (rc) {
+        LOG_ERR("pomodoro sync discovery failed: %d", rc);
+    }
+}
+
+static void disconnected(struct bt_conn *conn, uint8_t reason) {
+    ARG_UNUSED(reason);
+
+    if (conn != peripheral_conn) {
+        return;
+    }
+
+    bt_conn_unref(peripheral_conn);
+    peripheral_conn = NULL;
+    subscribe_params.value_handle = 0;
+}
+
+BT_CONN_CB_DEFINE(pomodoro_sync_conn_cb) = {
+    .security_changed = security_changed,
+    .disconnected = disconnected,
+};
+
+int pomodoro_sync_transport_send(const struct pomodoro_sync_packet *packet) {
+    ARG_UNUSED(packet);
+    return -ENOTSUP;
+}
+
+#endif
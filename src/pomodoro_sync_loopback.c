@@ -0,0 +1,70 @@
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+
+#include "pomodoro_sync.h"
+#include "pomodoro_workq.h"
+
+/* Packets that can wait for one connection event, like a link's TX buffers. */
+#define LOOPBACK_QUEUE_LEN 4
+
+/*
+ * Stand-in transport for builds without a BLE split link: packets are handed
+ * to the local receiver from the Pomodoro queue at the next connection event,
+ * every CONFIG_ZMK_POMODORO_SYNC_LOOPBACK_INTERVAL_MS of uptime, as a
+ * notification would be.
+ */
+static struct k_spinlock loopback_lock;
+static struct pomodoro_sync_packet queue[LOOPBACK_QUEUE_LEN];
+static uint8_t queue_head;
+static uint8_t queue_len;
+
+static void loopback_work_handler(struct k_work *work) {
+    ARG_UNUSED(work);
+
+    for (;;) {
+        struct pomodoro_sync_packet packet;
+
+        k_spinlock_key_t key = k_spin_lock(&loopback_lock);
+        if (queue_len == 0) {
+            k_spin_unlock(&loopback_lock, key);
+            return;
+        }
+        packet = queue[queue_head];
+        queue_head = (queue_head + 1) % LOOPBACK_QUEUE_LEN;
+        queue_len--;
+        k_spin_unlock(&loopback_lock, key);
+
+        pomodoro_sync_receive(&packet);
+    }
+}
+
+K_WORK_DELAYABLE_DEFINE(loopback_work, loopback_work_handler);
+
+static k_timeout_t next_connection_event(void) {
+    const int64_t interval_ms = CONFIG_ZMK_POMODORO_SYNC_LOOPBACK_INTERVAL_MS;
+
+    if (interval_ms == 0) {
+        return K_NO_WAIT;
+    }
+    /*
+     * Absolute, so tick rounding cannot push delivery past the event. A
+     * packet sent while an event is being serviced, like the answer to a
+     * forwarded press, still goes out in it.
+     */
+    return K_TIMEOUT_ABS_MS(ROUND_UP(k_uptime_get(), interval_ms));
+}
+
+int pomodoro_sync_transport_send(const struct pomodoro_sync_packet *packet) {
+    k_spinlock_key_t key = k_spin_lock(&loopback_lock);
+    if (queue_len == LOOPBACK_QUEUE_LEN) {
+        k_spin_unlock(&loopback_lock, key);
+        return -ENOMEM;
+    }
+    queue[(queue_head + queue_len) % LOOPBACK_QUEUE_LEN] = *packet;
+    queue_len++;
+    k_spin_unlock(&loopback_lock, key);
+
+    /* Not rescheduled: everything queued before the event goes out with it. */
+    k_work_schedule_for_queue(pomodoro_work_q(), &loopback_work, next_connection_event());
+    return 0;
+}
@@ -0,0 +1,165 @@
+#include <zephyr/kernel.h>
+#include <zephyr/init.h>
+#include <zephyr/sys/util.h>
+
+#include "pomodoro_clock.h"
+#include "pomodoro_stats.h"
+#include "pomodoro_timer.h"
+#include "pomodoro_trace.h"
+
+static struct k_spinlock timer_lock;
+static struct pomodoro_timer *heap[CONFIG_ZMK_POMODORO_TIMER_SLOTS];
+static size_t heap_len;
+
+/* What the clock is armed for, so moving a timer that is not the root costs nothing. */
+static bool clock_armed;
+static int64_t clock_deadline_ms;
+
+/* Set while expired timers are being run; the final re-arm covers everything they start. */
+static bool expiring;
+
+static inline void heap_place(size_t i, struct pomodoro_timer *timer) {
+    heap[i] = timer;
+    timer->slot = i;
+}
+
+static void sift_up(size_t i) {
+    struct pomodoro_timer *timer = heap[i];
+
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (heap[parent]->deadline_ms <= timer->deadline_ms) {
+            break;
+        }
+        heap_place(i, heap[parent]);
+        i = parent;
+    }
+    heap_place(i, timer);
+}
+
+static void sift_down(size_t i) {
+    struct pomodoro_timer *timer = heap[i];
+
+    for (;;) {
+        size_t child = 2 * i + 1;
+        if (child >= heap_len) {
+            break;
+        }
+        if (child + 1 < heap_len && heap[child + 1]->deadline_ms < heap[child]->deadline_ms) {
+            child++;
+        }
+        if (timer->deadline_ms <= heap[child]->deadline_ms) {
+            break;
+        }
+        heap_place(i, heap[child]);
+        i = child;
+    }
+    heap_place(i, timer);
+}
+
+static void heap_fix(struct pomodoro_timer *timer) {
+    sift_up(timer->slot);
+    sift_down(timer->slot);
+}
+
+static void heap_remove(struct pomodoro_timer *timer) {
+    size_t i = timer->slot;
+    struct pomodoro_timer *last = heap[--heap_len];
+
+    timer->slot = -1;
+    if (i < heap_len) {
+        heap_place(i, last);
+        heap_fix(last);
+    }
+}
+
+static void rearm_locked(void) {
+    if (expiring) {
+        return;
+    }
+
+    if (heap_len == 0) {
+        if (clock_armed) {
+            pomodoro_clock_cancel();
+            clock_armed = false;
+        }
+        return;
+    }
+
+    if (!clock_armed || heap[0]->deadline_ms != clock_deadline_ms) {
+        clock_deadline_ms = heap[0]->deadline_ms;
+        clock_armed = true;
+        pomodoro_clock_arm(clock_deadline_ms);
+    }
+}
+
+int pomodoro_timer_start(struct pomodoro_timer *timer, int64_t deadline_ms) {
+    k_spinlock_key_t key = k_spin_lock(&timer_lock);
+
+    if (timer->slot < 0) {
+        if (heap_len == ARRAY_SIZE(heap)) {
+            k_spin_unlock(&timer_lock, key);
+            return -ENOMEM;
+        }
+        heap_place(heap_len++, timer);
+    }
+
+    timer->deadline_ms = deadline_ms;
+    heap_fix(timer);
+    rearm_locked();
+    k_spin_unlock(&timer_lock, key);
+    return 0;
+}
+
+void pomodoro_timer_stop(struct pomodoro_timer *timer) {
+    k_spinlock_key_t key = k_spin_lock(&timer_lock);
+
+    if (timer->slot >= 0) {
+        heap_remove(timer);
+        rearm_locked();
+    }
+    k_spin_unlock(&timer_lock, key);
+}
+
+bool pomodoro_timer_is_armed(const struct pomodoro_timer *timer) {
+    k_spinlock_key_t key = k_spin_lock(&timer_lock);
+    bool armed = timer->slot >= 0;
+    k_spin_unlock(&timer_lock, key);
+    return armed;
+}
+
+/*
+ * Every clock wakeup lands here, whether it was the armed deadline or a kick
+ * after sleep, so the clock is treated as disarmed and armed afresh for
+ * whatever is left once the due timers have run.
+ */
+static void timer_expiry(void) {
+    uint16_t fired = 0;
+
+    pomodoro_stats_inc(POMODORO_STAT_TICK_WAKEUPS);
+
+    k_spinlock_key_t key = k_spin_lock(&timer_lock);
+    clock_armed = false;
+    expiring = true;
+
+    while (heap_len > 0 && heap[0]->deadline_ms <= pomodoro_clock_now_ms()) {
+        struct pomodoro_timer *timer = heap[0];
+
+        heap_remove(timer);
+        fired++;
+        k_spin_unlock(&timer_lock, key);
+        timer->handler(timer);
+        key = k_spin_lock(&timer_lock);
+    }
+
+    expiring = false;
+    rearm_locked();
+    k_spin_unlock(&timer_lock, key);
+
+    pomodoro_trace(POMODORO_TRACE_WAKE, fired);
+}
+
+/* Ahead of every APPLICATION-level user, which may start timers from its own init. */
+static int pomodoro_timer_init(void) { return pomodoro_clock_init(timer_expiry); }
+
+SYS_INIT(pomodoro_timer_init, POST_KERNEL, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT);
@@ -0,0 +1,134 @@
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/barrier.h>
+#include <zephyr/sys/util.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include "pomodoro_clock.h"
+#include "pomodoro_trace.h"
+
+LOG_MODULE_DECLARE(pomodoro, CONFIG_ZMK_LOG_LEVEL);
+
+#define TRACE_ENTRIES CONFIG_ZMK_POMODORO_TRACE_ENTRIES
+#define TRACE_PER_LINE 4
+
+BUILD_ASSERT(IS_POWER_OF_TWO(TRACE_ENTRIES), "trace ring size must be a power of two");
+
+static struct pomodoro_trace_entry ring[TRACE_ENTRIES];
+/* Entries ever claimed; entry n lives in ring[n % TRACE_ENTRIES]. */
+static atomic_t head = ATOMIC_INIT(0);
+/* First entry a dump shows, moved by 'pomo trace clear'. */
+static atomic_t cleared = ATOMIC_INIT(0);
+/* Where the next log flush resumes. */
+static atomic_t logged = ATOMIC_INIT(0);
+
+static uint8_t lap_of(uint32_t n) { return (uint8_t)(n / TRACE_ENTRIES + 1); }
+
+void pomodoro_trace(enum pomodoro_trace_event event, uint16_t arg) {
+    uint32_t n = (uint32_t)atomic_inc(&head);
+    struct pomodoro_trace_entry *entry = &ring[n % TRACE_ENTRIES];
+
+    entry->time_ms = (uint32_t)pomodoro_clock_now_ms();
+    entry->event = event;
+    entry->arg = arg;
+    /* Published last: a reader that sees this lap sees the rest of the entry. */
+    barrier_dmem_fence_full();
+    entry->lap = lap_of(n);
+}
+
+/*
+ * Copies entry n. False if it was never written, is still being written, or
+ * a writer a full lap ahead claimed the slot while it was being copied.
+ */
+static bool read_entry(uint32_t n, struct pomodoro_trace_entry *out) {
+    const struct pomodoro_trace_entry *entry = &ring[n % TRACE_ENTRIES];
+
+    if (entry->lap != lap_of(n)) {
+        return false;
+    }
+
+    barrier_dmem_fence_full();
+    *out = *entry;
+    barrier_dmem_fence_full();
+
+    return (uint32_t)atomic_get(&head) - n <= TRACE_ENTRIES && out->lap == lap_of(n);
+}
+
+typedef void (*pomodoro_trace_line_t)(void *arg, const char *line);
+
+/*
+ * Emits entries from `from` up to the current head as a header line and
+ * hex lines of raw little-endian entries, the only format the host decoder
+ * reads. Entries lost to a wrap are skipped; ones lost to a race print as
+ * '-'. Returns the index the dump stopped at.
+ */
+static uint32_t format_trace(uint32_t from, pomodoro_trace_line_t emit, void *arg) {
+    uint32_t end = atomic_get(&head);
+    uint32_t start = from;
+    char line[sizeof("@T 4294967295") + TRACE_PER_LINE * (1 + 2 * sizeof(struct pomodoro_trace_entry))];
+
+    if (end - start > TRACE_ENTRIES) {
+        start = end - TRACE_ENTRIES;
+    }
+    if ((int32_t)(atomic_get(&cleared) - start) > 0) {
+        start = atomic_get(&cleared);
+    }
+
+    snprintf(line, sizeof(line), "@TRACE v1 first=%u count=%u now=%u", start, end - start,
+             (uint32_t)pomodoro_clock_now_ms());
+    emit(arg, line);
+
+    for (uint32_t n = start; n != end;) {
+        size_t len = snprintf(line, sizeof(line), "@T %u", n);
+
+        for (int i = 0; i < TRACE_PER_LINE && n != end; i++, n++) {
+            struct pomodoro_trace_entry entry;
+
+            if (!read_entry(n, &entry)) {
+                len += snprintf(line + len, sizeof(line) - len, " -");
+                continue;
+            }
+
+            const uint8_t *bytes = (const uint8_t *)&entry;
+            line[len++] = ' ';
+            for (size_t b = 0; b < sizeof(entry); b++) {
+                len += snprintf(line + len, sizeof(line) - len, "%02x", bytes[b]);
+            }
+        }
+        emit(arg, line);
+    }
+
+    return end;
+}
+
+static void log_line(void *arg, const char *line) {
+    ARG_UNUSED(arg);
+    LOG_INF("%s", line);
+}
+
+void pomodoro_trace_log(void) { atomic_set(&logged, format_trace(atomic_get(&logged), log_line, NULL)); }
+
+#if IS_ENABLED(CONFIG_SHELL)
+#include <zephyr/shell/shell.h>
+
+static void shell_line(void *arg, const char *line) {
+    shell_print((const struct shell *)arg, "%s", line);
+}
+
+static int cmd_trace(const struct shell *sh, size_t argc, char **argv) {
+    if (argc > 1 && strcmp(argv[1], "clear") == 0) {
+        atomic_set(&cleared, atomic_get(&head));
+        shell_print(sh, "pomodoro trace cleared");
+        return 0;
+    }
+
+    format_trace(atomic_get(&cleared), shell_line, (void *)sh);
+    return 0;
+}
+
+SHELL_SUBCMD_ADD((pomo), trace, NULL, "Dump the trace for scripts/pomo_trace_decode.py; 'clear'",
+                 cmd_trace, 1, 1);
+#endif
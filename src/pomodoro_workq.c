@@ -0,0 +1,22 @@
+#include <zephyr/kernel.h>
+#include <zephyr/init.h>
+
+#include "pomodoro_workq.h"
+
+K_THREAD_STACK_DEFINE(pomodoro_work_q_stack, CONFIG_ZMK_POMODORO_WORKQUEUE_STACK_SIZE);
+
+static struct k_work_q pomodoro_work_q_data;
+
+struct k_work_q *pomodoro_work_q(void) { return &pomodoro_work_q_data; }
+
+static int pomodoro_work_q_init(void) {
+    static const struct k_work_queue_config cfg = {.name = "pomodoro"};
+
+    k_work_queue_start(&pomodoro_work_q_data, pomodoro_work_q_stack,
+                       K_THREAD_STACK_SIZEOF(pomodoro_work_q_stack),
+                       CONFIG_ZMK_POMODORO_WORKQUEUE_PRIORITY, &cfg);
+    return 0;
+}
+
+/* Before the APPLICATION-level engine init, which may already arm the clock. */
+SYS_INIT(pomodoro_work_q_init, POST_KERNEL, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT);
@@ -0,0 +1,38 @@
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/ztest.h>
+
+#include "pomodoro.h"
+#include "pomodoro_clock.h"
+#include "pomodoro_stats.h"
+#include "pomodoro_test.h"
+
+void pomodoro_test_wait_ms(uint32_t ms) {
+#if IS_ENABLED(CONFIG_ZMK_POMODORO_CLOCK_VIRTUAL)
+    pomodoro_clock_advance(ms);
+#else
+    k_sleep(K_MSEC(ms));
+#endif
+}
+
+void pomodoro_test_run_out_phase(void) {
+    struct pomodoro_status status = pomodoro_current_status();
+    int64_t left_ms = status.phase_end_ms - pomodoro_clock_now_ms();
+
+    zassert_not_equal(status.phase_end_ms, 0, "no phase running in state %d", status.state);
+    pomodoro_test_wait_ms(MAX(left_ms, 0) + POMODORO_TEST_SLACK_MS);
+}
+
+void pomodoro_test_reset(void) {
+    pomodoro_stop();
+    /* Kernel time, whatever the clock: the queues have to drain either way. */
+    k_sleep(K_MSEC(POMODORO_TEST_SLACK_MS));
+    pomodoro_stats_reset();
+}
+
+void pomodoro_test_print_metrics(const char *run) {
+    static char json[1024];
+
+    zassert_true(pomodoro_stats_json(json, sizeof(json)) > 0, "stats JSON does not fit");
+    printk("@METRICS %s %s\n", run, json);
+}
@@ -0,0 +1,84 @@
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include "pomodoro.h"
+#include "pomodoro_clock.h"
+#include "pomodoro_stats.h"
+#include "pomodoro_test.h"
+
+/*
+ * The counter clock on the emulated 16-bit counter (emul_counter.c), which
+ * wraps every 65.536 s. Wraps that pass with nothing armed, idle or paused,
+ * must still reach the Pomodoro clock, and a phase many wraps long must end
+ * on time.
+ */
+
+#define WRAP_MS 65536
+/* Two kernel ticks at native_sim's 100 Hz: one for the alarm, one for the test's own sleep. */
+#define TOLERANCE_MS 20
+
+struct clock_mark {
+    int64_t clock_ms;
+    int64_t uptime_ms;
+};
+
+static struct clock_mark mark(void) {
+    return (struct clock_mark){pomodoro_clock_now_ms(), k_uptime_get()};
+}
+
+static void assert_tracks_uptime(struct clock_mark since) {
+    int64_t clock_ms = pomodoro_clock_now_ms() - since.clock_ms;
+    int64_t uptime_ms = k_uptime_get() - since.uptime_ms;
+
+    zassert_within(clock_ms, uptime_ms, TOLERANCE_MS, "clock moved %lld ms in %lld ms of uptime",
+                   clock_ms, uptime_ms);
+}
+
+ZTEST(pomodoro_counter, test_wraps_while_idle) {
+    pomodoro_test_reset();
+    struct clock_mark since = mark();
+
+    k_sleep(K_MSEC(3 * WRAP_MS + 1234));
+
+    assert_tracks_uptime(since);
+    zassert_equal(pomodoro_stats_get(POMODORO_STAT_TICK_WAKEUPS), 0,
+                  "the wrap guard reached the engine");
+}
+
+ZTEST(pomodoro_counter, test_wraps_while_paused) {
+    pomodoro_test_reset();
+    zassert_ok(pomodoro_start());
+    k_sleep(K_SECONDS(60));
+    zassert_ok(pomodoro_pause());
+
+    uint32_t remaining_s = pomodoro_current_status().remaining_seconds;
+    struct clock_mark since = mark();
+
+    k_sleep(K_MSEC(2 * WRAP_MS + 4321));
+
+    assert_tracks_uptime(since);
+    zassert_ok(pomodoro_resume());
+
+    struct pomodoro_status status = pomodoro_current_status();
+    zassert_equal(status.remaining_seconds, remaining_s, "pause lost or gained time");
+    zassert_within(status.phase_end_ms - pomodoro_clock_now_ms(), remaining_s * 1000LL, 1000);
+}
+
+ZTEST(pomodoro_counter, test_phase_across_wraps_ends_on_time) {
+    pomodoro_test_reset();
+    zassert_ok(pomodoro_start());
+
+    int64_t end_ms = k_uptime_get() + POMODORO_DEFAULT_WORK_SECONDS * 1000LL;
+
+    k_sleep(K_TIMEOUT_ABS_MS(end_ms - TOLERANCE_MS));
+    zassert_equal(pomodoro_current_status().state, POMODORO_STATE_WORK, "phase ended early");
+
+    k_sleep(K_TIMEOUT_ABS_MS(end_ms + 2 * TOLERANCE_MS));
+    zassert_equal(pomodoro_current_status().state, POMODORO_STATE_BREAK,
+                  "phase end lost across %d wraps", POMODORO_DEFAULT_WORK_SECONDS * 1000 / WRAP_MS);
+    zassert_equal(pomodoro_stats_get(POMODORO_STAT_TICK_WAKEUPS), 1);
+
+    pomodoro_test_print_metrics("counter");
+}
+
+ZTEST_SUITE(pomodoro_counter, NULL, NULL, NULL, NULL, NULL);
@@ -0,0 +1,66 @@
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/ztest.h>
+
+#include "pomodoro_display_bench.h"
+#include "pomodoro_test.h"
+
+/*
+ * Per-frame CRCs of the display bench replay on the 160x68 dummy panel of
+ * boards/native_sim.overlay with display.conf. Each entry covers only what
+ * that frame flushed, so a change shows up at the first frame it touches.
+ *
+ * The table ends in a 0 sentinel that is not a frame. Until the CRCs of a
+ * native_sim build are pasted in front of it the test fails and prints the
+ * table to paste, after checking the frames it describes; a change to the
+ * view, the fonts or LVGL needs the same again.
+ */
+static const uint32_t golden[] = {
+    0,
+};
+
+#define GOLDEN_FRAMES ((int)ARRAY_SIZE(golden) - 1)
+
+static void print_table(const struct pomodoro_display_bench_frame *replay, int count) {
+    printk("display bench: %d frames, paste into golden[]:\n", count);
+    for (int i = 0; i < count; i++) {
+        printk("%s0x%08x,%s", i % 6 == 0 ? "    " : " ", replay[i].crc,
+               i % 6 == 5 || i == count - 1 ? "\n" : "");
+    }
+}
+
+ZTEST(pomodoro_display_bench, test_replay_matches_golden) {
+    const struct pomodoro_display_bench_frame *replay;
+    uint32_t render_max = 0, rows = 0;
+
+    pomodoro_test_reset();
+    int count = pomodoro_display_bench_run(&replay);
+
+    zassert_true(count > 0, "display bench did not run (%d)", count);
+
+    for (int i = 0; i < count; i++) {
+        render_max = MAX(render_max, replay[i].render_cyc);
+        rows += replay[i].flushed_rows;
+    }
+    printk("@METRICS display_bench {\"frames\":%d,\"render_max_us\":%u,\"flushed_rows\":%u,"
+           "\"crc\":\"%08x\"}\n",
+           count, k_cyc_to_us_floor32(render_max), rows,
+           pomodoro_display_bench_crc(replay, count));
+
+    if (count != GOLDEN_FRAMES) {
+        print_table(replay, count);
+    }
+    zassert_true(GOLDEN_FRAMES > 0, "golden table is empty; generate it from the table above");
+
+    for (int i = 0; i < MIN(count, GOLDEN_FRAMES); i++) {
+        if (replay[i].crc != golden[i]) {
+            print_table(replay, count);
+        }
+        zassert_equal(replay[i].crc, golden[i],
+                      "frame %d is the first to differ: crc %08x, golden %08x", i, replay[i].crc,
+                      golden[i]);
+    }
+    zassert_equal(count, GOLDEN_FRAMES, "%d frames, golden has %d", count, GOLDEN_FRAMES);
+}
+
+ZTEST_SUITE(pomodoro_display_bench, NULL, NULL, NULL, NULL, NULL);
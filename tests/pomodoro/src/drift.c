@@ -0,0 +1,67 @@
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include "pomodoro.h"
+#include "pomodoro_clock.h"
+#include "pomodoro_test.h"
+
+/*
+ * Pause/resume drift on the virtual clock. After every cycle, at odd
+ * millisecond offsets, the phase must end exactly where it started plus its
+ * length plus the time spent paused, and the next phase must start there.
+ */
+
+#define CYCLES 100
+#define RUN_MAX_MS 9973
+#define PAUSE_MAX_MS 59999
+
+BUILD_ASSERT(CYCLES * RUN_MAX_MS < POMODORO_DEFAULT_WORK_SECONDS * 1000,
+             "the cycles must fit in one work phase");
+
+static uint32_t xorshift32(uint32_t *state) {
+    uint32_t x = *state;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+ZTEST(pomodoro_drift, test_pause_resume_is_exact) {
+    uint32_t seed = 0x9e3779b9;
+
+    pomodoro_test_reset();
+    zassert_ok(pomodoro_start());
+
+    int64_t expected_end_ms = pomodoro_clock_now_ms() + POMODORO_DEFAULT_WORK_SECONDS * 1000LL;
+    zassert_equal(pomodoro_current_status().phase_end_ms, expected_end_ms);
+
+    for (int i = 0; i < CYCLES; i++) {
+        uint32_t run_ms = 1 + xorshift32(&seed) % RUN_MAX_MS;
+        uint32_t pause_ms = 1 + xorshift32(&seed) % PAUSE_MAX_MS;
+
+        pomodoro_clock_advance(run_ms);
+        zassert_ok(pomodoro_pause());
+        zassert_equal(pomodoro_current_status().state, POMODORO_STATE_PAUSED, "cycle %d", i);
+
+        pomodoro_clock_advance(pause_ms);
+        zassert_ok(pomodoro_resume());
+        expected_end_ms += pause_ms;
+
+        zassert_equal(pomodoro_current_status().phase_end_ms, expected_end_ms,
+                      "cycle %d: phase end moved off its deadline", i);
+    }
+
+    pomodoro_clock_advance(expected_end_ms - pomodoro_clock_now_ms() - 1);
+    zassert_equal(pomodoro_current_status().state, POMODORO_STATE_WORK, "phase ended early");
+
+    pomodoro_clock_advance(1);
+    struct pomodoro_status status = pomodoro_current_status();
+    zassert_equal(status.state, POMODORO_STATE_BREAK, "phase did not end on its deadline");
+    zassert_equal(status.phase_end_ms, expected_end_ms + status.phase_total_seconds * 1000LL,
+                  "break did not start at the work phase's end");
+
+    pomodoro_test_print_metrics("drift");
+}
+
+ZTEST_SUITE(pomodoro_drift, NULL, NULL, NULL, NULL, NULL);
@@ -0,0 +1,129 @@
+#define DT_DRV_COMPAT zmk_pomodoro_test_counter
+
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/counter.h>
+
+/*
+ * A counter as narrow as the wrap handling has to cope with: 16 bits at
+ * 1 kHz, read off kernel uptime, so it wraps every 65.536 s. Its one alarm
+ * channel fires from a k_timer, in interrupt context like a compare match.
+ */
+
+#define EMUL_COUNTER_TOP 0xffff
+#define EMUL_COUNTER_FREQ 1000
+
+struct emul_counter_data {
+    struct k_timer timer;
+    counter_alarm_callback_t callback;
+    void *user_data;
+};
+
+static uint32_t emul_counter_ticks(void) { return (uint32_t)k_uptime_get() & EMUL_COUNTER_TOP; }
+
+static void emul_counter_expiry(struct k_timer *timer) {
+    const struct device *dev = k_timer_user_data_get(timer);
+    struct emul_counter_data *data = dev->data;
+    counter_alarm_callback_t callback = data->callback;
+
+    /* One-shot: the channel is free again before the callback runs. */
+    data->callback = NULL;
+    if (callback) {
+        callback(dev, 0, emul_counter_ticks(), data->user_data);
+    }
+}
+
+static int emul_counter_start(const struct device *dev) {
+    ARG_UNUSED(dev);
+    return 0;
+}
+
+static int emul_counter_stop(const struct device *dev) {
+    ARG_UNUSED(dev);
+    return -ENOTSUP;
+}
+
+static int emul_counter_get_value(const struct device *dev, uint32_t *ticks) {
+    ARG_UNUSED(dev);
+    *ticks = emul_counter_ticks();
+    return 0;
+}
+
+static int emul_counter_set_alarm(const struct device *dev, uint8_t chan_id,
+                                  const struct counter_alarm_cfg *alarm_cfg) {
+    struct emul_counter_data *data = dev->data;
+
+    if (chan_id != 0 || alarm_cfg->ticks > EMUL_COUNTER_TOP ||
+        (alarm_cfg->flags & COUNTER_ALARM_CFG_ABSOLUTE)) {
+        return -EINVAL;
+    }
+    if (data->callback) {
+        return -EBUSY;
+    }
+
+    data->callback = alarm_cfg->callback;
+    data->user_data = alarm_cfg->user_data;
+    k_timer_start(&data->timer, K_MSEC(alarm_cfg->ticks), K_NO_WAIT);
+    return 0;
+}
+
+static int emul_counter_cancel_alarm(const struct device *dev, uint8_t chan_id) {
+    struct emul_counter_data *data = dev->data;
+
+    if (chan_id != 0) {
+        return -EINVAL;
+    }
+
+    k_timer_stop(&data->timer);
+    data->callback = NULL;
+    return 0;
+}
+
+static int emul_counter_set_top_value(const struct device *dev,
+                                      const struct counter_top_cfg *cfg) {
+    ARG_UNUSED(dev);
+    ARG_UNUSED(cfg);
+    return -ENOTSUP;
+}
+
+static uint32_t emul_counter_get_pending_int(const struct device *dev) {
+    ARG_UNUSED(dev);
+    return 0;
+}
+
+static uint32_t emul_counter_get_top_value(const struct device *dev) {
+    ARG_UNUSED(dev);
+    return EMUL_COUNTER_TOP;
+}
+
+static const struct counter_driver_api emul_counter_api = {
+    .start = emul_counter_start,
+    .stop = emul_counter_stop,
+    .get_value = emul_counter_get_value,
+    .set_alarm = emul_counter_set_alarm,
+    .cancel_alarm = emul_counter_cancel_alarm,
+    .set_top_value = emul_counter_set_top_value,
+    .get_pending_int = emul_counter_get_pending_int,
+    .get_top_value = emul_counter_get_top_value,
+};
+
+static int emul_counter_init(const struct device *dev) {
+    struct emul_counter_data *data = dev->data;
+
+    k_timer_init(&data->timer, emul_counter_expiry, NULL);
+    k_timer_user_data_set(&data->timer, (void *)dev);
+    return 0;
+}
+
+static const struct counter_config_info emul_counter_info = {
+    .max_top_value = EMUL_COUNTER_TOP,
+    .freq = EMUL_COUNTER_FREQ,
+    .flags = COUNTER_CONFIG_INFO_COUNT_UP,
+    .channels = 1,
+};
+
+static struct emul_counter_data emul_counter_data;
+
+/* Pre-kernel like the nRF RTC driver, so it is ready before the Pomodoro clock starts. */
+DEVICE_DT_INST_DEFINE(0, emul_counter_init, NULL, &emul_counter_data, &emul_counter_info,
+                      PRE_KERNEL_1, CONFIG_COUNTER_INIT_PRIORITY, &emul_counter_api);
@@ -0,0 +1,30 @@
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/ztest.h>
+
+#include "pomodoro_fuzz.h"
+
+/*
+ * The engine fuzzer with fixed seeds, so CI replays the same sequences on
+ * every run. A failure reports the seed and step for `pomo fuzz`.
+ */
+
+#define STEPS 200000
+
+static const uint32_t seeds[] = {1, 0x2545f491, 0xdeadbeef};
+
+ZTEST(pomodoro_fuzz, test_fixed_seeds) {
+    for (size_t i = 0; i < ARRAY_SIZE(seeds); i++) {
+        struct pomodoro_fuzz_result result;
+        int err = pomodoro_fuzz_run(STEPS, seeds[i], &result);
+
+        zassert_ok(err, "seed %u step %u: %s (state %d session %u)", seeds[i], result.steps - 1,
+                   result.failure, result.status.state, result.status.session);
+        zassert_equal(result.steps, STEPS);
+        zassert_true(result.transitions > 0, "seed %u never reached a phase end", seeds[i]);
+        printk("fuzz seed %u: %u steps, %u timed transitions\n", seeds[i], result.steps,
+               result.transitions);
+    }
+}
+
+ZTEST_SUITE(pomodoro_fuzz, NULL, NULL, NULL, NULL, NULL);
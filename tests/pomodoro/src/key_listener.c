@@ -0,0 +1,178 @@
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include <zmk/event_manager.h>
+#include <zmk/events/position_state_changed.h>
+
+#include "pomodoro.h"
+#include "pomodoro_test.h"
+
+/*
+ * What the any-key listener does with a real key event in each state, and
+ * what a press costs it while it has nothing to do. The cost is shown next to
+ * one k_mutex lock/read/unlock, an illustrative reference for a press that
+ * takes ctx.lock, not a measurement of the listener this one replaced. Cycle
+ * counts are recorded, not asserted. native_sim's cycle counter does not move
+ * while code runs, so read them from qemu_cortex_m3 or hardware.
+ */
+
+#define KEY_EVENTS 10000
+
+extern const struct zmk_listener zmk_listener_pomodoro_any_key;
+
+static K_MUTEX_DEFINE(reference_lock);
+static volatile enum pomodoro_state reference_state;
+
+static struct zmk_position_state_changed_event key_press = {
+    .header = {.event = &zmk_event_zmk_position_state_changed},
+    .data = {.position = 0, .state = true},
+};
+
+static uint32_t empty_loop_cycles(void) {
+    uint32_t start = k_cycle_get_32();
+
+    for (int i = 0; i < KEY_EVENTS; i++) {
+        __asm__ volatile("" ::: "memory");
+    }
+    return k_cycle_get_32() - start;
+}
+
+static uint32_t listener_cycles(void) {
+    uint32_t start = k_cycle_get_32();
+
+    for (int i = 0; i < KEY_EVENTS; i++) {
+        zmk_listener_pomodoro_any_key.callback(&key_press.header);
+    }
+    return k_cycle_get_32() - start;
+}
+
+/* One lock/read/unlock of a k_mutex, which is what taking ctx.lock costs at the least. */
+static uint32_t mutex_reference_cycles(void) {
+    uint32_t start = k_cycle_get_32();
+
+    for (int i = 0; i < KEY_EVENTS; i++) {
+        k_mutex_lock(&reference_lock, K_FOREVER);
+        bool act = reference_state == POMODORO_STATE_BREAK ||
+                   reference_state == POMODORO_STATE_PAUSED;
+        k_mutex_unlock(&reference_lock);
+        __asm__ volatile("" ::"r"(act) : "memory");
+    }
+    return k_cycle_get_32() - start;
+}
+
+static void measure(const char *run) {
+    uint32_t empty = empty_loop_cycles();
+    uint32_t listener = listener_cycles() - empty;
+    uint32_t mutex = mutex_reference_cycles() - empty;
+    uint32_t generation = pomodoro_status_generation();
+
+    /* Nothing to do in this state: no press may reach the engine. */
+    k_sleep(K_MSEC(POMODORO_TEST_SLACK_MS));
+    zassert_equal(pomodoro_status_generation(), generation, "a key press changed the state");
+
+    printk("@METRICS %s {\"events\":%u,\"listener_cyc\":%u,\"mutex_ref_cyc\":%u,"
+           "\"listener_ns_per_event\":%u,\"mutex_ref_ns_per_event\":%u}\n",
+           run, KEY_EVENTS, listener, mutex,
+           (uint32_t)(k_cyc_to_ns_floor64(listener) / KEY_EVENTS),
+           (uint32_t)(k_cyc_to_ns_floor64(mutex) / KEY_EVENTS));
+}
+
+/* A key event through the event manager; the action runs later, on the Pomodoro queue. */
+static void key_event(bool pressed) {
+    raise_zmk_position_state_changed((struct zmk_position_state_changed){
+        .position = 0,
+        .state = pressed,
+        .timestamp = k_uptime_get(),
+    });
+    k_sleep(K_MSEC(POMODORO_TEST_SLACK_MS));
+}
+
+static void enter_break(void) {
+    zassert_ok(pomodoro_start());
+    pomodoro_test_run_out_phase();
+    zassert_equal(pomodoro_current_status().state, POMODORO_STATE_BREAK);
+}
+
+ZTEST(pomodoro_key_listener, test_break_press_skips_break) {
+    pomodoro_test_reset();
+    enter_break();
+
+    /* Releases are not presses. */
+    key_event(false);
+    zassert_equal(pomodoro_current_status().state, POMODORO_STATE_BREAK, "release ended the break");
+
+    key_event(true);
+    struct pomodoro_status status = pomodoro_current_status();
+
+    zassert_equal(status.state, POMODORO_STATE_WORK, "press left state %d", status.state);
+    zassert_equal(status.session, 2, "press skipped to session %u", status.session);
+    zassert_equal(status.remaining_seconds, status.phase_total_seconds);
+    pomodoro_stop();
+}
+
+ZTEST(pomodoro_key_listener, test_paused_break_press_skips_break) {
+    pomodoro_test_reset();
+    enter_break();
+    zassert_ok(pomodoro_pause());
+
+    key_event(true);
+    struct pomodoro_status status = pomodoro_current_status();
+
+    zassert_equal(status.state, POMODORO_STATE_WORK, "press left state %d", status.state);
+    zassert_equal(status.session, 2);
+    pomodoro_stop();
+}
+
+ZTEST(pomodoro_key_listener, test_paused_work_press_resumes) {
+    pomodoro_test_reset();
+    zassert_ok(pomodoro_start());
+    pomodoro_test_wait_ms(90 * 1000);
+    zassert_ok(pomodoro_pause());
+
+    struct pomodoro_status paused = pomodoro_current_status();
+
+    key_event(true);
+    struct pomodoro_status status = pomodoro_current_status();
+
+    zassert_equal(status.state, POMODORO_STATE_WORK, "press left state %d", status.state);
+    zassert_equal(status.session, paused.session);
+    zassert_within(status.remaining_seconds, paused.remaining_seconds, 1, "resume lost %d s",
+                   paused.remaining_seconds - status.remaining_seconds);
+
+    /* Running again, so the next press has nothing to do. */
+    uint32_t generation = pomodoro_status_generation();
+
+    key_event(true);
+    zassert_equal(pomodoro_status_generation(), generation, "a press in work changed the state");
+    pomodoro_stop();
+}
+
+ZTEST(pomodoro_key_listener, test_idle_and_work_presses_do_nothing) {
+    pomodoro_test_reset();
+    uint32_t generation = pomodoro_status_generation();
+
+    key_event(true);
+    zassert_equal(pomodoro_status_generation(), generation, "a press in idle changed the state");
+    zassert_equal(pomodoro_current_status().state, POMODORO_STATE_IDLE);
+
+    zassert_ok(pomodoro_start());
+    generation = pomodoro_status_generation();
+    key_event(true);
+    zassert_equal(pomodoro_status_generation(), generation, "a press in work changed the state");
+    zassert_equal(pomodoro_current_status().state, POMODORO_STATE_WORK);
+    pomodoro_stop();
+}
+
+ZTEST(pomodoro_key_listener, test_idle) {
+    pomodoro_test_reset();
+    measure("key_listener_idle");
+}
+
+ZTEST(pomodoro_key_listener, test_work) {
+    pomodoro_test_reset();
+    zassert_ok(pomodoro_start());
+    measure("key_listener_work");
+    pomodoro_stop();
+}
+
+ZTEST_SUITE(pomodoro_key_listener, NULL, NULL, NULL, NULL, NULL);
@@ -0,0 +1,91 @@
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include "pomodoro.h"
+#include "pomodoro_settings.h"
+#include "pomodoro_test.h"
+
+/*
+ * Round trips through the settings subsystem on native_sim's simulated flash:
+ * state is saved through the debounced commit, the engine is dropped as on a
+ * reset, and what comes back is read from flash again.
+ */
+
+/* Lets the deferred commit reach flash. */
+static void wait_saved(void) {
+    k_sleep(K_MSEC(CONFIG_ZMK_SETTINGS_SAVE_DEBOUNCE + POMODORO_TEST_SLACK_MS));
+}
+
+static void assert_restored(bool on_break, uint8_t session, uint32_t remaining_s) {
+    struct pomodoro_status status = pomodoro_current_status();
+
+    zassert_equal(status.state, POMODORO_STATE_PAUSED, "restored into state %d", status.state);
+    zassert_equal(status.on_break, on_break);
+    zassert_equal(status.session, session);
+    /* Elapsed time is saved in whole seconds. */
+    zassert_within(status.remaining_seconds, remaining_s, 1);
+    zassert_equal(status.phase_end_ms, 0, "a restored phase must not run on");
+}
+
+ZTEST(pomodoro_persist, test_paused_work_round_trip) {
+    pomodoro_test_reset();
+    zassert_ok(pomodoro_start());
+    k_sleep(K_SECONDS(90));
+    zassert_ok(pomodoro_pause());
+
+    uint32_t remaining_s = pomodoro_current_status().remaining_seconds;
+
+    wait_saved();
+    /* One write for the start and one for the pause; the 90 s of ticks wrote nothing. */
+    zassert_equal(pomodoro_settings_write_count(), 2);
+
+    pomodoro_test_reboot();
+    assert_restored(false, 1, remaining_s);
+
+    zassert_ok(pomodoro_resume());
+    pomodoro_test_run_out_phase();
+    zassert_equal(pomodoro_current_status().state, POMODORO_STATE_BREAK);
+}
+
+ZTEST(pomodoro_persist, test_running_phase_restores_at_last_save) {
+    pomodoro_test_reset();
+    zassert_ok(pomodoro_start());
+
+    uint32_t length_s = pomodoro_current_status().phase_total_seconds;
+
+    /* Ticks never save, so the last save is the start itself. */
+    k_sleep(K_SECONDS(90));
+    wait_saved();
+
+    pomodoro_test_reboot();
+    assert_restored(false, 1, length_s);
+}
+
+ZTEST(pomodoro_persist, test_break_round_trip) {
+    pomodoro_test_reset();
+    zassert_ok(pomodoro_start());
+    pomodoro_test_run_out_phase();
+    k_sleep(K_SECONDS(30));
+    zassert_ok(pomodoro_pause());
+
+    struct pomodoro_status before = pomodoro_current_status();
+
+    zassert_true(before.on_break);
+    wait_saved();
+
+    pomodoro_test_reboot();
+    assert_restored(true, before.session, before.remaining_seconds);
+}
+
+ZTEST(pomodoro_persist, test_stop_round_trip) {
+    pomodoro_test_reset();
+    zassert_ok(pomodoro_start());
+    wait_saved();
+    zassert_ok(pomodoro_stop());
+    wait_saved();
+
+    pomodoro_test_reboot();
+    zassert_equal(pomodoro_current_status().state, POMODORO_STATE_IDLE);
+}
+
+ZTEST_SUITE(pomodoro_persist, NULL, NULL, NULL, NULL, NULL);
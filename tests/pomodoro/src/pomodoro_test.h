@@ -0,0 +1,21 @@
+#pragma once
+
+#include <stdint.h>
+
+/* Slack past a deadline before a test looks at the transition it causes. */
+#define POMODORO_TEST_SLACK_MS 10
+
+/*
+ * Moves Pomodoro time forward: kernel time on the uptime and counter clocks,
+ * pomodoro_clock_advance() on the virtual one.
+ */
+void pomodoro_test_wait_ms(uint32_t ms);
+
+/* Waits until just past the running phase's end, so its timed transition has run. */
+void pomodoro_test_run_out_phase(void);
+
+/* Stops the engine and lets the work it queued run, then opens a new stats window. */
+void pomodoro_test_reset(void);
+
+/* Prints the stats window as "@METRICS <run> <json>", the line testcase.yaml records. */
+void pomodoro_test_print_metrics(const char *run);
@@ -0,0 +1,143 @@
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/ztest.h>
+
+#include <zmk/event_manager.h>
+#include <zmk/events/pomodoro_state_changed.h>
+
+#include "pomodoro.h"
+#include "pomodoro_stats.h"
+#include "pomodoro_test.h"
+
+/*
+ * Full cycles of the plan on kernel time, with pauses, break extends and
+ * skips mixed in. Each cycle checks the phase count, one wakeup per timed
+ * phase end, and the display redraws against the countdown policy, then
+ * prints its stats window.
+ */
+
+#define PAUSE_S 120
+
+struct cycle_mix {
+    const char *run;
+    /* Bit n - 1 selects session n. */
+    uint8_t pause;
+    uint8_t extend;
+    uint8_t skip;
+};
+
+static atomic_t state_events;
+
+static int count_state_changed(const zmk_event_t *eh) {
+    if (as_zmk_pomodoro_state_changed(eh) != NULL) {
+        atomic_inc(&state_events);
+    }
+    return ZMK_EV_EVENT_BUBBLE;
+}
+
+ZMK_LISTENER(pomodoro_session_test, count_state_changed);
+ZMK_SUBSCRIPTION(pomodoro_session_test, zmk_pomodoro_state_changed);
+
+/* Values the countdown shows on its way from `from_s` down to `to_s` seconds left. */
+static uint32_t countdown_flips(uint32_t from_s, uint32_t to_s) {
+    uint32_t flips = 0;
+
+    for (uint32_t r = to_s; r < from_s; r++) {
+        if (!IS_ENABLED(CONFIG_ZMK_POMODORO_COUNTDOWN_ADAPTIVE) || r <= 60 || r % 60 == 0) {
+            flips++;
+        }
+    }
+    return flips;
+}
+
+static void run_cycle(const struct cycle_mix *mix) {
+    uint32_t flips = 0;
+    uint32_t timed_ends = 0;
+
+    pomodoro_test_reset();
+    atomic_set(&state_events, 0);
+
+    zassert_ok(pomodoro_start());
+
+    for (uint8_t session = 1; session <= POMODORO_MAX_SESSIONS; session++) {
+        uint8_t bit = BIT(session - 1);
+        struct pomodoro_status status = pomodoro_current_status();
+
+        zassert_equal(status.state, POMODORO_STATE_WORK, "%s: session %u not working", mix->run,
+                      session);
+        zassert_equal(status.session, session);
+
+        if (mix->pause & bit) {
+            pomodoro_test_wait_ms(status.phase_total_seconds / 2 * 1000);
+            zassert_ok(pomodoro_pause());
+            zassert_equal(pomodoro_current_status().state, POMODORO_STATE_PAUSED);
+            pomodoro_test_wait_ms(PAUSE_S * 1000);
+            zassert_ok(pomodoro_resume());
+        }
+
+        flips += countdown_flips(status.phase_total_seconds, 0);
+        pomodoro_test_run_out_phase();
+        timed_ends++;
+
+        status = pomodoro_current_status();
+        zassert_equal(status.state, POMODORO_STATE_BREAK, "%s: session %u not on break", mix->run,
+                      session);
+
+        if (mix->extend & bit) {
+            zassert_ok(pomodoro_break_extend());
+            status = pomodoro_current_status();
+        }
+
+        uint32_t break_s = status.phase_total_seconds;
+        if (mix->skip & bit) {
+            pomodoro_test_wait_ms(break_s / 2 * 1000);
+            zassert_ok(pomodoro_break_skip());
+            flips += countdown_flips(break_s, break_s - break_s / 2);
+        } else {
+            pomodoro_test_run_out_phase();
+            flips += countdown_flips(break_s, 0);
+            timed_ends++;
+        }
+    }
+
+    zassert_equal(pomodoro_current_status().state, POMODORO_STATE_IDLE, "%s: cycle did not end",
+                  mix->run);
+    zassert_equal(pomodoro_stats_get(POMODORO_STAT_PHASES), 2 * POMODORO_MAX_SESSIONS);
+    zassert_equal(pomodoro_stats_get(POMODORO_STAT_TICK_WAKEUPS), timed_ends,
+                  "%s: wakeups other than the phase ends", mix->run);
+
+    if (IS_ENABLED(CONFIG_ZMK_POMODORO_DISPLAY)) {
+        uint32_t events = atomic_get(&state_events);
+        uint32_t redraws = pomodoro_stats_get(POMODORO_STAT_DISPLAY_REDRAWS);
+
+        /* One redraw per countdown flip; a state change may share one or add its own. */
+        zassert_between_inclusive(redraws, flips - events, flips + events,
+                                  "%s: %u redraws for %u countdown flips and %u state changes",
+                                  mix->run, redraws, flips, events);
+    }
+
+    pomodoro_test_print_metrics(mix->run);
+}
+
+ZTEST(pomodoro_session, test_plain_cycle) {
+    run_cycle(&(struct cycle_mix){.run = "plain"});
+}
+
+ZTEST(pomodoro_session, test_paused_cycle) {
+    run_cycle(&(struct cycle_mix){.run = "paused", .pause = 0x0f});
+}
+
+ZTEST(pomodoro_session, test_extended_cycle) {
+    run_cycle(&(struct cycle_mix){.run = "extended", .extend = 0x0f});
+}
+
+ZTEST(pomodoro_session, test_skipped_cycle) {
+    run_cycle(&(struct cycle_mix){.run = "skipped", .skip = 0x0f});
+}
+
+ZTEST(pomodoro_session, test_mixed_cycle) {
+    run_cycle(&(struct cycle_mix){.run = "mixed", .pause = 0x05, .extend = 0x0a, .skip = 0x0c});
+}
+
+ZTEST_SUITE(pomodoro_session, NULL, NULL, NULL, NULL, NULL);
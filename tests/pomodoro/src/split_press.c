@@ -0,0 +1,137 @@
+#include <zephyr/device.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/ztest.h>
+
+#include <string.h>
+
+#include <drivers/behavior.h>
+#include <zmk/behavior.h>
+
+#include "pomodoro.h"
+#include "pomodoro_sync.h"
+#include "pomodoro_test.h"
+
+/*
+ * A keymap press on the central, carried to the half that runs the timer the
+ * way ZMK's split service runs a global behavior there: the binding's device
+ * name, cut to what the run-behavior payload holds, is written at the next
+ * connection event and looked up again on the peripheral. Both halves are
+ * this image. The central's side is the stand-in below; the peripheral's is
+ * the shipped behavior nodes, the driver, the engine and the sync sender,
+ * answering over the loopback transport.
+ */
+
+#define INTERVAL_MS CONFIG_ZMK_POMODORO_SYNC_LOOPBACK_INTERVAL_MS
+
+BUILD_ASSERT(INTERVAL_MS > 0, "forwarded presses wait for a connection event");
+
+/* ZMK_SPLIT_RUN_BEHAVIOR_DEV_LEN in ZMK's split service: 8 characters and the terminator. */
+#define SPLIT_BEHAVIOR_DEV_LEN 9
+
+/* The behavior as the central's keymap binds it: by its full device name. */
+#define BINDING(node) DEVICE_DT_NAME(DT_NODELABEL(node))
+
+struct split_run_behavior {
+    char behavior_dev[SPLIT_BEHAVIOR_DEV_LEN];
+    uint32_t position;
+};
+
+static struct split_run_behavior in_flight;
+static int run_result;
+
+/* The peripheral's split service. Releases are opaque to these behaviors and not forwarded. */
+static void peripheral_run_behavior(struct k_work *work) {
+    ARG_UNUSED(work);
+
+    struct zmk_behavior_binding binding = {.behavior_dev = in_flight.behavior_dev};
+    struct zmk_behavior_binding_event event = {
+        .position = in_flight.position,
+        .timestamp = k_uptime_get(),
+    };
+    const struct device *dev = zmk_behavior_get_binding(binding.behavior_dev);
+
+    if (dev == NULL) {
+        run_result = -ENODEV;
+        return;
+    }
+
+    const struct behavior_driver_api *api = dev->api;
+    run_result = api->binding_pressed(&binding, event);
+}
+
+K_WORK_DELAYABLE_DEFINE(forward_work, peripheral_run_behavior);
+
+/* The central's side: its copy of the behavior notes the press, the link carries it. */
+static void central_press(const char *behavior_dev, uint32_t position) {
+    pomodoro_sync_note_request();
+
+    memset(&in_flight, 0, sizeof(in_flight));
+    strncpy(in_flight.behavior_dev, behavior_dev, SPLIT_BEHAVIOR_DEV_LEN - 1);
+    in_flight.position = position;
+    run_result = -EINPROGRESS;
+
+    k_work_schedule(&forward_work, K_TIMEOUT_ABS_MS(ROUND_UP(k_uptime_get(), INTERVAL_MS)));
+}
+
+struct press {
+    const char *behavior_dev;
+    enum pomodoro_state state;
+};
+
+/* Press to mirror, through the link both ways, within one connection interval. */
+static void assert_press(const struct press *press, int round) {
+    struct pomodoro_status mirrored;
+    uint32_t received = pomodoro_sync_mirror_generation();
+
+    central_press(press->behavior_dev, round);
+    k_sleep(K_MSEC(INTERVAL_MS + POMODORO_TEST_SLACK_MS));
+
+    zassert_ok(run_result, "%s did not run on the peripheral (%d)", press->behavior_dev,
+               run_result);
+    zassert_equal(pomodoro_sync_mirror_generation() - received, 1, "%s", press->behavior_dev);
+    zassert_true(pomodoro_sync_mirror_status(&mirrored));
+    zassert_equal(mirrored.state, press->state, "%s: mirror in state %d, expected %d",
+                  press->behavior_dev, mirrored.state, press->state);
+    zassert_true(pomodoro_sync_last_latency_ms() <= INTERVAL_MS, "%s took %u ms, interval %u ms",
+                 press->behavior_dev, pomodoro_sync_last_latency_ms(), INTERVAL_MS);
+}
+
+ZTEST(pomodoro_split_press, test_forwarded_press_to_state) {
+    static const struct press work_presses[] = {
+        {BINDING(pomo_start), POMODORO_STATE_WORK},
+        {BINDING(pomo_pause), POMODORO_STATE_PAUSED},
+        {BINDING(pomo_resume), POMODORO_STATE_WORK},
+        {BINDING(pomo_smart), POMODORO_STATE_PAUSED},
+        {BINDING(pomo_smart), POMODORO_STATE_WORK},
+    };
+    static const struct press break_presses[] = {
+        {BINDING(pomo_break_extend), POMODORO_STATE_BREAK},
+        {BINDING(pomo_break_skip), POMODORO_STATE_WORK},
+        {BINDING(pomo_stop), POMODORO_STATE_IDLE},
+    };
+
+    pomodoro_test_reset();
+    k_sleep(K_MSEC(INTERVAL_MS + POMODORO_TEST_SLACK_MS));
+
+    for (int round = 0; round < 5; round++) {
+        for (size_t i = 0; i < ARRAY_SIZE(work_presses); i++) {
+            /* Odd offsets, so presses land all over the interval. */
+            k_sleep(K_MSEC(7 * i + 13 * round + 1));
+            assert_press(&work_presses[i], round);
+        }
+
+        pomodoro_test_run_out_phase();
+        k_sleep(K_MSEC(INTERVAL_MS + POMODORO_TEST_SLACK_MS));
+
+        for (size_t i = 0; i < ARRAY_SIZE(break_presses); i++) {
+            k_sleep(K_MSEC(11 * i + 13 * round + 1));
+            assert_press(&break_presses[i], round);
+        }
+    }
+
+    zassert_true(pomodoro_sync_max_latency_ms() <= INTERVAL_MS);
+    pomodoro_test_print_metrics("split_press");
+}
+
+ZTEST_SUITE(pomodoro_split_press, NULL, NULL, NULL, NULL, NULL);
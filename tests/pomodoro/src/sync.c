@@ -0,0 +1,125 @@
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include <zmk/events/pomodoro_state_changed.h>
+
+#include "pomodoro.h"
+#include "pomodoro_sync.h"
+#include "pomodoro_test.h"
+
+/*
+ * The peripheral side of the mirror, sent back to itself over the loopback
+ * transport: what a session costs on the link, and whether the receiver ends
+ * up with the status the engine has.
+ */
+
+#define INTERVAL_MS CONFIG_ZMK_POMODORO_SYNC_LOOPBACK_INTERVAL_MS
+
+/* Lets the next connection event hand the queued packets to the receiver. */
+static void wait_delivered(void) { k_sleep(K_MSEC(INTERVAL_MS + POMODORO_TEST_SLACK_MS)); }
+
+static void assert_mirrors_engine(void) {
+    struct pomodoro_status local = pomodoro_current_status();
+    struct pomodoro_status mirrored;
+
+    wait_delivered();
+    zassert_true(pomodoro_sync_mirror_status(&mirrored), "nothing mirrored");
+    zassert_equal(mirrored.state, local.state, "mirror in state %d, engine in %d", mirrored.state,
+                  local.state);
+    zassert_equal(mirrored.session, local.session);
+    zassert_equal(mirrored.max_sessions, local.max_sessions);
+    zassert_equal(mirrored.on_break, local.on_break);
+    zassert_equal(mirrored.paused, local.paused);
+    zassert_equal(mirrored.phase_total_seconds, local.phase_total_seconds);
+    zassert_within(mirrored.remaining_seconds, local.remaining_seconds, 1);
+    /* The countdown left the peripheral up to one interval before it arrived. */
+    zassert_within(mirrored.phase_end_ms, local.phase_end_ms, INTERVAL_MS + POMODORO_TEST_SLACK_MS,
+                   "mirrored phase ends %lld ms off", mirrored.phase_end_ms - local.phase_end_ms);
+}
+
+ZTEST(pomodoro_sync, test_session_bytes) {
+    pomodoro_test_reset();
+    wait_delivered();
+
+    uint32_t received = pomodoro_sync_mirror_generation();
+
+    /* Start, pause, resume, break, the next session's work, stop. */
+    zassert_ok(pomodoro_start());
+    pomodoro_test_wait_ms(60 * 1000);
+    zassert_ok(pomodoro_pause());
+    zassert_ok(pomodoro_resume());
+    pomodoro_test_run_out_phase();
+    pomodoro_test_run_out_phase();
+    zassert_ok(pomodoro_stop());
+    wait_delivered();
+
+    uint32_t packets = 6;
+
+    /* Transitions only: the 30 minutes of ticks sent nothing. */
+    zassert_equal(pomodoro_sync_bytes_sent(), packets * sizeof(struct pomodoro_sync_packet),
+                  "%u bytes for one session", pomodoro_sync_bytes_sent());
+    zassert_equal(pomodoro_sync_mirror_generation() - received, packets);
+    pomodoro_test_print_metrics("sync");
+}
+
+ZTEST(pomodoro_sync, test_mirror_round_trip) {
+    pomodoro_test_reset();
+    assert_mirrors_engine();
+
+    zassert_ok(pomodoro_start());
+    assert_mirrors_engine();
+
+    pomodoro_test_wait_ms(90 * 1000);
+    assert_mirrors_engine();
+
+    zassert_ok(pomodoro_pause());
+    assert_mirrors_engine();
+
+    pomodoro_test_wait_ms(45 * 1000);
+    zassert_ok(pomodoro_resume());
+    assert_mirrors_engine();
+
+    pomodoro_test_run_out_phase();
+    assert_mirrors_engine();
+
+    zassert_ok(pomodoro_break_extend());
+    assert_mirrors_engine();
+
+    zassert_ok(pomodoro_break_skip());
+    assert_mirrors_engine();
+
+    zassert_ok(pomodoro_stop());
+    assert_mirrors_engine();
+}
+
+/*
+ * A pause and a resume that reach the listener as one commit: the same state,
+ * session, flags and total as the packet before, only a later phase end.
+ */
+ZTEST(pomodoro_sync, test_coalesced_commit_moves_phase_end) {
+    struct pomodoro_status mirrored;
+
+    pomodoro_test_reset();
+    zassert_ok(pomodoro_start());
+    pomodoro_test_wait_ms(60 * 1000);
+    assert_mirrors_engine();
+
+    struct pomodoro_status resumed = pomodoro_current_status();
+    uint32_t received = pomodoro_sync_mirror_generation();
+
+    resumed.phase_end_ms += 45 * 1000;
+    raise_zmk_pomodoro_state_changed((struct zmk_pomodoro_state_changed){.status = resumed});
+    wait_delivered();
+
+    zassert_equal(pomodoro_sync_mirror_generation() - received, 1, "moved phase end not sent");
+    zassert_true(pomodoro_sync_mirror_status(&mirrored));
+    zassert_within(mirrored.phase_end_ms, resumed.phase_end_ms,
+                   INTERVAL_MS + POMODORO_TEST_SLACK_MS, "mirrored phase ends %lld ms off",
+                   mirrored.phase_end_ms - resumed.phase_end_ms);
+
+    /* The next real commit brings the mirror back to the engine. */
+    zassert_ok(pomodoro_stop());
+    assert_mirrors_engine();
+}
+
+ZTEST_SUITE(pomodoro_sync, NULL, NULL, NULL, NULL, NULL);
@@ -0,0 +1,87 @@
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include "pomodoro_workq.h"
+#include "pomodoro_test.h"
+
+/*
+ * Worst-case scheduling latency of work submitted from an interrupt, the way
+ * keyscan and split work reach the system queue, while a long item runs:
+ *
+ * - system probe: system-queue work behind a Pomodoro item, which is what
+ *   the dedicated queue is for;
+ * - Pomodoro probe: Pomodoro work behind a system-queue item, the price of
+ *   a preemptible Pomodoro thread.
+ *
+ * The busy item stands in for a transition with its listeners and a flash
+ * write. Built with CONFIG_ZMK_POMODORO_WORKQUEUE=n, both queues are the
+ * system queue, which is the comparison the pomodoro.workq.shared scenario
+ * records.
+ */
+
+#define BUSY_US 5000
+#define ROUNDS 40
+
+static struct k_work_q *busy_q;
+static struct k_work_q *probe_q;
+static uint32_t probe_submitted;
+static uint32_t probe_max_cyc;
+
+static void busy_handler(struct k_work *work) {
+    ARG_UNUSED(work);
+    k_busy_wait(BUSY_US);
+}
+
+K_WORK_DEFINE(busy_work, busy_handler);
+
+static void probe_handler(struct k_work *work) {
+    ARG_UNUSED(work);
+    probe_max_cyc = MAX(probe_max_cyc, k_cycle_get_32() - probe_submitted);
+}
+
+K_WORK_DEFINE(probe_work, probe_handler);
+
+static void probe_timer_expiry(struct k_timer *timer) {
+    ARG_UNUSED(timer);
+    probe_submitted = k_cycle_get_32();
+    k_work_submit_to_queue(probe_q, &probe_work);
+}
+
+static K_TIMER_DEFINE(probe_timer, probe_timer_expiry, NULL);
+
+/* Max microseconds from the interrupt to the probe running, over probes spread across the item. */
+static uint32_t worst_probe_latency_us(struct k_work_q *busy, struct k_work_q *probe) {
+    busy_q = busy;
+    probe_q = probe;
+    probe_max_cyc = 0;
+
+    for (int i = 0; i < ROUNDS; i++) {
+        /* Lands anywhere from the start of the item to just before its end. */
+        uint32_t offset_us = 100 + (i * 379) % (BUSY_US - 200);
+
+        k_work_submit_to_queue(busy_q, &busy_work);
+        k_timer_start(&probe_timer, K_USEC(offset_us), K_NO_WAIT);
+        k_sleep(K_USEC(2 * BUSY_US));
+    }
+    return k_cyc_to_us_ceil32(probe_max_cyc);
+}
+
+ZTEST(pomodoro_workq, test_worst_case_latency) {
+    pomodoro_test_reset();
+
+    uint32_t sys_probe_us = worst_probe_latency_us(pomodoro_work_q(), &k_sys_work_q);
+    uint32_t pomodoro_probe_us = worst_probe_latency_us(&k_sys_work_q, pomodoro_work_q());
+
+    printk("@METRICS workq_%s {\"rounds\":%u,\"busy_us\":%u,\"sys_probe_max_us\":%u,"
+           "\"pomodoro_probe_max_us\":%u}\n",
+           IS_ENABLED(CONFIG_ZMK_POMODORO_WORKQUEUE) ? "dedicated" : "shared", ROUNDS, BUSY_US,
+           sys_probe_us, pomodoro_probe_us);
+
+    if (IS_ENABLED(CONFIG_ZMK_POMODORO_WORKQUEUE)) {
+        zassert_true(sys_probe_us < BUSY_US / 2,
+                     "system work waited %u us behind a %u us Pomodoro item", sys_probe_us,
+                     BUSY_US);
+    }
+}
+
+ZTEST_SUITE(pomodoro_workq, NULL, NULL, NULL, NULL, NULL);
@@ -0,0 +1,58 @@
+#include <zephyr/kernel.h>
+#include <zephyr/init.h>
+#include <zephyr/logging/log.h>
+
+/*
+ * The pieces of the ZMK app the module expects around it, without the rest of
+ * the app: the `zmk` log module, which ZMK registers in its main.c, the
+ * behavior lookup by name, and with the display, ZMK's display queue and
+ * status screen bring-up.
+ */
+LOG_MODULE_REGISTER(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#if IS_ENABLED(CONFIG_ZMK_POMODORO_BEHAVIORS)
+
+#include <zephyr/device.h>
+
+#include <zmk/behavior.h>
+
+/* As ZMK's behavior.c: a ready device whose name matches exactly. */
+const struct device *zmk_behavior_get_binding(const char *name) {
+    return device_get_binding(name);
+}
+
+#endif
+
+#if IS_ENABLED(CONFIG_ZMK_DISPLAY)
+
+#include <zmk/display.h>
+#include <zmk/display/status_screen.h>
+
+#include <lvgl.h>
+
+static bool display_initialized;
+
+/* ZMK's default: display work shares the system queue. */
+struct k_work_q *zmk_display_work_q(void) { return &k_sys_work_q; }
+
+bool zmk_display_is_initialized(void) { return display_initialized; }
+
+/* The module's first draw request is queued behind this, so it sees the flag set. */
+static void display_init_handler(struct k_work *work) {
+    ARG_UNUSED(work);
+
+    lv_scr_load(zmk_display_status_screen());
+    display_initialized = true;
+}
+
+K_WORK_DEFINE(display_init_work, display_init_handler);
+
+static int display_shim_init(void) {
+    k_work_submit_to_queue(zmk_display_work_q(), &display_init_work);
+    return 0;
+}
+
+/* After LVGL and the engine's own APPLICATION-level init. */
+SYS_INIT(display_shim_init, APPLICATION, 99);
+
+#endif